@@ -18,6 +18,9 @@ public class MidiFileReader
     [DllImport("JDKsMidi", EntryPoint = "ParseMidiFile", CallingConvention = CallingConvention.StdCall)]
     private static extern bool _Dll_ParseMidiFile(IntPtr filePath);
 
+    [DllImport("JDKsMidi", EntryPoint = "ParseMidiData", CallingConvention = CallingConvention.StdCall)]
+    private static extern bool _Dll_ParseMidiData(byte[] midiData, int midiDataLength);
+
     [DllImport("JDKsMidi", EntryPoint = "GetMidiDuration", CallingConvention = CallingConvention.StdCall)]
     private static extern double _Dll_GetMidiDuration();
 
@@ -82,6 +85,23 @@ public class MidiFileReader
         bool successfulParse = _Dll_ParseMidiFile(asCStyleString);
         Marshal.FreeHGlobal(asCStyleString);
 
+        return ReadParsedMidiData(successfulParse);
+    }
+
+    public bool ParseMidiData(byte[] midiData)
+    {
+        // For Midi files that are already in memory, such as TextAsset bytes from Resources/MidiDB
+        if (midiData == null || midiData.Length == 0)
+        {
+            return false;
+        }
+
+        bool successfulParse = _Dll_ParseMidiData(midiData, midiData.Length);
+        return ReadParsedMidiData(successfulParse);
+    }
+
+    protected bool ReadParsedMidiData(bool successfulParse)
+    {
         if (successfulParse == false)
         {
             _Dll_ClearMidiData();
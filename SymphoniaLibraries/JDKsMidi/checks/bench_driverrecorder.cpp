@@ -0,0 +1,80 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_driverrecorder: plays midi files through MIDIManager into a MIDIDriverRecorder and
+// prints the send lateness (p50/p99/max) and the throughput of every file.
+//   bench_driverrecorder [-realtime] file.mid ...
+// Without -realtime the songs are played on a virtual clock as fast as possible, which
+// measures the throughput of sequencer, manager and driver. With -realtime they are played
+// on the steady clock in real time, which measures the scheduling jitter.
+// The "run_bench_driverrecorder" target runs it on the songs in MidiFileParser/Resources.
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/driverrecorder.h"
+#include "jdksmidi/timingengine.h"
+
+#include <cstring>
+
+using namespace jdksmidi;
+
+int main ( int argc, char **argv )
+{
+    bool realtime = false;
+    int first_file = 1;
+
+    if ( argc > 1 && strcmp ( argv[1], "-realtime" ) == 0 )
+    {
+        realtime = true;
+        ++first_file;
+    }
+
+    if ( first_file >= argc )
+    {
+        fprintf ( stderr, "usage: %s [-realtime] file.mid ...\n", argv[0] );
+        return 2;
+    }
+
+    MIDITimingSteadyClock steady_clock;
+    MIDITimingVirtualClock virtual_clock;
+    MIDITimingClock *clock = realtime ? ( MIDITimingClock * ) &steady_clock : ( MIDITimingClock * ) &virtual_clock;
+
+    // 1 ms ticks, as MIDIDriverWin32 uses
+    MIDIDriverRecorderBenchmark benchmark ( clock, 1000000 );
+    int rc = 0;
+
+    printf ( "%s clock\n", realtime ? "steady" : "virtual" );
+
+    for ( int i = first_file; i < argc; ++i )
+    {
+        MIDIDriverRecorderStats stats;
+
+        if ( !benchmark.Run ( argv[i], &stats ) )
+        {
+            fprintf ( stderr, "%s: can't play\n", argv[i] );
+            rc = 1;
+            continue;
+        }
+
+        MIDIDriverRecorderBenchmark::Print ( stdout, argv[i], stats );
+    }
+
+    return rc;
+}
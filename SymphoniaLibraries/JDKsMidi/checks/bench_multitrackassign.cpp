@@ -0,0 +1,131 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_multitrackassign: splits one track into the 17 tracks of a format 0 song with
+// MIDIMultiTrack::AssignEventsToTracks and with AssignEventsToTracksParallel.
+//   bench_multitrackassign [num_events]
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/multitrack.h"
+
+#include "benchtimer.h"
+
+#include <cstdlib>
+
+using namespace jdksmidi;
+
+static void MakeTrack ( MIDITrack *track, int num_events )
+{
+    for ( int i = 0; i < num_events; ++i )
+    {
+        MIDITimedBigMessage msg;
+        unsigned char chan = ( unsigned char ) ( ( i * 5 ) % 16 );
+
+        if ( i % 64 == 0 )
+            msg.SetTempo ( 400000 + i % 1000 );
+        else if ( i % 2 )
+            msg.SetNoteOff ( chan, ( unsigned char ) ( i % 128 ), 0 );
+        else
+            msg.SetNoteOn ( chan, ( unsigned char ) ( i % 128 ), 100 );
+
+        msg.SetTime ( ( MIDIClockTime ) i );
+        track->PutEvent ( msg );
+    }
+}
+
+static bool SameTracks ( const MIDIMultiTrack &a, const MIDIMultiTrack &b )
+{
+    if ( a.GetNumTracks() != b.GetNumTracks() )
+        return false;
+
+    for ( int t = 0; t < a.GetNumTracks(); ++t )
+    {
+        const MIDITrack *ta = a.GetTrack ( t );
+        const MIDITrack *tb = b.GetTrack ( t );
+
+        if ( ta->GetNumEvents() != tb->GetNumEvents() )
+            return false;
+
+        for ( int i = 0; i < ta->GetNumEvents(); ++i )
+        {
+            if ( !( *ta->GetEventAddress ( i ) == *tb->GetEventAddress ( i ) ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int main ( int argc, char **argv )
+{
+    // a track holds at most MIDIChunksPerTrack * MIDITrackChunkSize events
+    int num_events = argc > 1 ? atoi ( argv[1] ) : 200000;
+    const int num_runs = 5;
+
+    MIDITrack source;
+    MakeTrack ( &source, num_events );
+
+    MIDIMultiTrack serial ( 1 );
+    MIDIMultiTrack parallel ( 1 );
+    auto clear_serial = [&]()
+    {
+        serial.ClearAndResize ( 1 );
+    };
+    auto clear_parallel = [&]()
+    {
+        parallel.ClearAndResize ( 1 );
+    };
+
+    bool ok = true;
+    double serial_ns = BenchBestNs ( num_runs, clear_serial, [&]()
+    {
+        ok = serial.AssignEventsToTracks ( &source ) && ok;
+    } );
+
+    printf ( "%d events, best of %d runs\n", num_events, num_runs );
+    BenchReport ( "AssignEventsToTracks", serial_ns, num_events );
+
+    for ( int num_threads = 1; num_threads <= 8 && ok; num_threads *= 2 )
+    {
+        double parallel_ns = BenchBestNs ( num_runs, clear_parallel, [&]()
+        {
+            ok = parallel.AssignEventsToTracksParallel ( &source, num_threads ) && ok;
+        } );
+
+        char name[64];
+        sprintf ( name, "AssignEventsToTracksParallel, %d threads", num_threads );
+        BenchReport ( name, parallel_ns, num_events );
+
+        if ( !SameTracks ( serial, parallel ) )
+        {
+            fprintf ( stderr, "tracks differ with %d threads\n", num_threads );
+            return 1;
+        }
+    }
+
+    if ( !ok )
+    {
+        fprintf ( stderr, "a split failed\n" );
+        return 1;
+    }
+
+    return 0;
+}
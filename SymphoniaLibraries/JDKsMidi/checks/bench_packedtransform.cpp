@@ -0,0 +1,157 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_packedtransform: transposes and rechannels 1M events with MIDIProcessorTransposer and
+// MIDIProcessorRechannelizer, one message at a time, and with MIDIPackedTransform on arrays
+// of status, byte1 and byte2.
+//   bench_packedtransform [num_events]
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/process.h"
+#include "jdksmidi/packedtransform.h"
+
+#include "benchtimer.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace jdksmidi;
+
+static void MakeEvents ( std::vector<MIDITimedBigMessage> *events, int num_events )
+{
+    events->resize ( num_events );
+
+    for ( int i = 0; i < num_events; ++i )
+    {
+        MIDITimedBigMessage &msg = ( *events ) [i];
+        unsigned char chan = ( unsigned char ) ( i % 16 );
+        unsigned char note = ( unsigned char ) ( 24 + ( i * 7 ) % 84 );
+
+        if ( i % 8 == 7 )
+            msg.SetControlChange ( chan, 7, ( unsigned char ) ( i % 128 ) );
+        else if ( i % 2 )
+            msg.SetNoteOff ( chan, note, 0 );
+        else
+            msg.SetNoteOn ( chan, note, ( unsigned char ) ( 1 + i % 127 ) );
+
+        msg.SetTime ( ( MIDIClockTime ) i );
+    }
+}
+
+int main ( int argc, char **argv )
+{
+    int num_events = argc > 1 ? atoi ( argv[1] ) : 1000000;
+    const int num_runs = 5;
+
+    std::vector<MIDITimedBigMessage> source;
+    MakeEvents ( &source, num_events );
+
+    // up an octave, channel 2 to 5, channel 10 dropped
+    MIDIProcessorTransposer transposer;
+    MIDIProcessorRechannelizer rechannelizer;
+    MIDIMultiProcessor multi ( 2 );
+
+    transposer.SetAllTranspose ( 12 );
+
+    for ( int chan = 0; chan < 16; ++chan )
+        rechannelizer.SetRechanMap ( chan, chan );
+
+    rechannelizer.SetRechanMap ( 1, 4 );
+    rechannelizer.SetRechanMap ( 9, -1 );
+
+    multi.SetProcessor ( 0, &transposer );
+    multi.SetProcessor ( 1, &rechannelizer );
+
+    MIDIPackedTransform transform;
+    transform.SetFromTransposer ( transposer );
+    transform.SetFromRechannelizer ( rechannelizer );
+
+    std::vector<unsigned char> source_status ( num_events ), source_byte1 ( num_events ), source_byte2 ( num_events );
+
+    for ( int i = 0; i < num_events; ++i )
+    {
+        source_status[i] = source[i].GetStatus();
+        source_byte1[i] = source[i].GetByte1();
+        source_byte2[i] = source[i].GetByte2();
+    }
+
+    std::vector<MIDITimedBigMessage> work;
+    std::vector<char> kept ( num_events );
+    std::vector<unsigned char> status, byte1, byte2;
+    int scalar_dropped = 0, packed_dropped = 0;
+
+    double virtual_ns = BenchBestNs ( num_runs, [&]()
+    {
+        work = source;
+    }, [&]()
+    {
+        for ( int i = 0; i < num_events; ++i )
+            kept[i] = multi.Process ( &work[i] );
+    } );
+
+    auto prepare_arrays = [&]()
+    {
+        status = source_status;
+        byte1 = source_byte1;
+        byte2 = source_byte2;
+    };
+
+    double scalar_ns = BenchBestNs ( num_runs, prepare_arrays, [&]()
+    {
+        scalar_dropped = transform.ApplyScalar ( &status[0], &byte1[0], &byte2[0], num_events );
+    } );
+
+    double packed_ns = BenchBestNs ( num_runs, prepare_arrays, [&]()
+    {
+        packed_dropped = transform.Apply ( &status[0], &byte1[0], &byte2[0], num_events );
+    } );
+
+    // the packed events have to match the processed messages, dropped ones have status 0
+    int num_different = 0, virtual_dropped = 0;
+
+    for ( int i = 0; i < num_events; ++i )
+    {
+        if ( !kept[i] )
+        {
+            ++virtual_dropped;
+
+            if ( status[i] != 0 )
+                ++num_different;
+        }
+        else if ( status[i] != work[i].GetStatus() || byte1[i] != work[i].GetByte1() || byte2[i] != work[i].GetByte2() )
+        {
+            ++num_different;
+        }
+    }
+
+    printf ( "%d events, %d dropped, best of %d runs\n", num_events, virtual_dropped, num_runs );
+    BenchReport ( "Transposer + Rechannelizer (virtual)", virtual_ns, num_events );
+    BenchReport ( "MIDIPackedTransform::ApplyScalar", scalar_ns, num_events );
+    BenchReport ( "MIDIPackedTransform::Apply", packed_ns, num_events );
+
+    if ( num_different || packed_dropped != virtual_dropped || scalar_dropped != virtual_dropped )
+    {
+        fprintf ( stderr, "%d events of the processors and MIDIPackedTransform differ\n", num_different );
+        return 1;
+    }
+
+    return 0;
+}
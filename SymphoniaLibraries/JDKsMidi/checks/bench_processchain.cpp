@@ -0,0 +1,168 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_processchain: transpose, rechannel and velocity scale 1M events with the
+// virtual MIDIMultiProcessor chain and with the inline MIDIProcessorChain.
+//   bench_processchain [num_events]
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/process.h"
+#include "jdksmidi/processchain.h"
+
+#include "benchtimer.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace jdksmidi;
+
+// the lib has no virtual velocity scale, so the stage is wrapped the same way a user would
+class VelocityScaleProcessor : public MIDIProcessor
+{
+public:
+    MIDIStageVelocityScale stage;
+
+    virtual bool Process ( MIDITimedBigMessage *msg )
+    {
+        return stage.Process ( msg );
+    }
+};
+
+static void MakeEvents ( std::vector<MIDITimedBigMessage> *events, int num_events )
+{
+    events->resize ( num_events );
+
+    for ( int i = 0; i < num_events; ++i )
+    {
+        MIDITimedBigMessage &msg = ( *events ) [i];
+        unsigned char chan = ( unsigned char ) ( i % 16 );
+        unsigned char note = ( unsigned char ) ( 24 + ( i * 7 ) % 96 );
+
+        if ( i % 8 == 7 )
+            msg.SetControlChange ( chan, 7, ( unsigned char ) ( i % 128 ) );
+        else if ( i % 2 )
+            msg.SetNoteOff ( chan, note, 0 );
+        else
+            msg.SetNoteOn ( chan, note, ( unsigned char ) ( 1 + i % 127 ) );
+
+        msg.SetTime ( ( MIDIClockTime ) i );
+    }
+}
+
+int main ( int argc, char **argv )
+{
+    int num_events = argc > 1 ? atoi ( argv[1] ) : 1000000;
+    const int num_runs = 5;
+
+    std::vector<MIDITimedBigMessage> source;
+    std::vector<MIDITimedBigMessage> work;
+    MakeEvents ( &source, num_events );
+
+    // the same settings for both chains: up an octave, channel 2 to 5, channel 10 dropped
+    MIDIProcessorTransposer transposer;
+    MIDIProcessorRechannelizer rechannelizer;
+    VelocityScaleProcessor velocity;
+    MIDIMultiProcessor multi ( 3 );
+
+    transposer.SetAllTranspose ( 12 );
+
+    for ( int chan = 0; chan < 16; ++chan )
+        rechannelizer.SetRechanMap ( chan, chan );
+
+    rechannelizer.SetRechanMap ( 1, 4 );
+    rechannelizer.SetRechanMap ( 9, -1 );
+    velocity.stage.SetVelocityScale ( 80 );
+
+    multi.SetProcessor ( 0, &transposer );
+    multi.SetProcessor ( 1, &rechannelizer );
+    multi.SetProcessor ( 2, &velocity );
+
+    MIDIProcessorChain<MIDIStageTransposer, MIDIStageRechannelizer, MIDIStageVelocityScale> chain;
+    chain.GetStage<0>().SetAllTranspose ( 12 );
+    chain.GetStage<1>().SetRechanMap ( 1, 4 );
+    chain.GetStage<1>().SetRechanMap ( 9, -1 );
+    chain.GetStage<2>().SetVelocityScale ( 80 );
+
+    std::vector<MIDITimedBigMessage> virtual_result;
+    int virtual_left = 0, chain_left = 0, batch_left = 0;
+    auto prepare = [&]()
+    {
+        work = source;
+    };
+
+    double virtual_ns = BenchBestNs ( num_runs, prepare, [&]()
+    {
+        virtual_left = 0;
+
+        for ( int i = 0; i < num_events; ++i )
+        {
+            if ( multi.Process ( &work[i] ) )
+                ++virtual_left;
+            else
+                work[i].SetNoOp();
+        }
+    } );
+
+    virtual_result = work;
+
+    double chain_ns = BenchBestNs ( num_runs, prepare, [&]()
+    {
+        chain_left = 0;
+
+        // through the virtual Process() of the chain: one virtual call instead of four
+        MIDIProcessor *proc = &chain;
+
+        for ( int i = 0; i < num_events; ++i )
+        {
+            if ( proc->Process ( &work[i] ) )
+                ++chain_left;
+            else
+                work[i].SetNoOp();
+        }
+    } );
+
+    double batch_ns = BenchBestNs ( num_runs, prepare, [&]()
+    {
+        batch_left = chain.Process ( &work[0], num_events );
+    } );
+
+    // the chains have to agree, or the times mean nothing
+    bool same = virtual_left == chain_left && virtual_left == batch_left;
+
+    for ( int i = 0; i < num_events && same; ++i )
+    {
+        if ( !( virtual_result[i] == work[i] ) )
+            same = false;
+    }
+
+    printf ( "%d events, %d left after the chain, best of %d runs\n", num_events, batch_left, num_runs );
+    BenchReport ( "MIDIMultiProcessor (virtual stages)", virtual_ns, num_events );
+    BenchReport ( "MIDIProcessorChain::Process ( msg )", chain_ns, num_events );
+    BenchReport ( "MIDIProcessorChain::Process ( msgs, n )", batch_ns, num_events );
+
+    if ( !same )
+    {
+        fprintf ( stderr, "results of the chains differ\n" );
+        return 1;
+    }
+
+    return 0;
+}
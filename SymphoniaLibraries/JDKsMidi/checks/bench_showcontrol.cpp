@@ -0,0 +1,281 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_showcontrol: dispatches a cue-heavy stream of MIDI Show Control messages (go, timed
+// go, stop, resume and load with cue numbers, lists and paths, set, fire, and messages for
+// another device) with MIDIShowControlDispatcher, from raw bytes and from sysex events.
+//   bench_showcontrol [num_messages]
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/showcontrolparser.h"
+
+#include "benchtimer.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace jdksmidi;
+
+static const uchar DEVICE_ID = 5;
+static const uchar OTHER_DEVICE_ID = 6;
+
+// counts the calls and adds up the cue numbers, so the dispatch can not be left out
+class CountingHandle : public MIDISCHandle
+{
+public:
+    unsigned long calls;
+    unsigned long cue_sum;
+
+    CountingHandle() : calls ( 0 ), cue_sum ( 0 )
+    {
+    }
+
+    void Count ( const MIDICue &q )
+    {
+        ++calls;
+        cue_sum += q.GetV1() + q.GetV2();
+    }
+
+    virtual bool Go ( const MIDICue &q )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Go ( const MIDICue &q, const MIDICue & )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Go ( const MIDICue &q, const MIDICue &, const MIDICue & )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool TimedGo ( uchar, uchar, uchar, uchar, uchar, const MIDICue &q )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Stop ( const MIDICue &q )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Resume ( const MIDICue &q )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Load ( const MIDICue &q, const MIDICue & )
+    {
+        Count ( q );
+        return true;
+    }
+
+    virtual bool Set ( ulong ctrl_num, ulong ctrl_val )
+    {
+        ++calls;
+        cue_sum += ctrl_num + ctrl_val;
+        return true;
+    }
+
+    virtual bool Fire ( uchar macro_num )
+    {
+        ++calls;
+        cue_sum += macro_num;
+        return true;
+    }
+};
+
+static void PutNumber ( std::vector<uchar> *msg, unsigned long n )
+{
+    char digits[16];
+    int len = sprintf ( digits, "%lu", n );
+    msg->insert ( msg->end(), digits, digits + len );
+}
+
+// cue "n.f" or "n"
+static void PutCue ( std::vector<uchar> *msg, unsigned long n, unsigned long f )
+{
+    PutNumber ( msg, n );
+
+    if ( f )
+    {
+        msg->push_back ( '.' );
+        PutNumber ( msg, f );
+    }
+}
+
+// message i of the stream, adds what the handle is to count to *calls and *cue_sum
+static void MakeMessage ( int i, std::vector<uchar> *msg, unsigned long *calls, unsigned long *cue_sum )
+{
+    unsigned long cue = 1 + i % 9000;
+    unsigned long fract = i % 3 ? i % 10 : 0;
+    int kind = i % 16;
+    uchar command = MIDI_SC_GO;
+
+    if ( kind == 9 )
+        command = MIDI_SC_TIMED_GO;
+    else if ( kind == 10 )
+        command = MIDI_SC_STOP;
+    else if ( kind == 11 )
+        command = MIDI_SC_RESUME;
+    else if ( kind == 12 )
+        command = MIDI_SC_LOAD;
+    else if ( kind == 13 )
+        command = MIDI_SC_SET;
+    else if ( kind == 14 )
+        command = MIDI_SC_FIRE;
+
+    uchar header[] = { 0xf0, 0x7f, kind == 15 ? OTHER_DEVICE_ID : DEVICE_ID, 0x02, 0x01, command };
+    msg->assign ( header, header + sizeof ( header ) );
+
+    if ( command == MIDI_SC_SET )
+    {
+        uchar data[] = { ( uchar ) ( cue & 0x7f ), ( uchar ) ( cue >> 7 ), ( uchar ) ( i & 0x7f ), 0 };
+        msg->insert ( msg->end(), data, data + sizeof ( data ) );
+        *cue_sum += cue + ( i & 0x7f );
+    }
+    else if ( command == MIDI_SC_FIRE )
+    {
+        msg->push_back ( ( uchar ) ( i & 0x7f ) );
+        *cue_sum += i & 0x7f;
+    }
+    else
+    {
+        if ( command == MIDI_SC_TIMED_GO )
+        {
+            uchar time[] = { 1, ( uchar ) ( i % 60 ), ( uchar ) ( i % 59 ), ( uchar ) ( i % 30 ), 0 };
+            msg->insert ( msg->end(), time, time + sizeof ( time ) );
+        }
+
+        PutCue ( msg, cue, fract );
+
+        // lists and paths on some gos and the loads
+        if ( kind == 6 || kind == 7 || kind == 8 || kind == 12 )
+        {
+            msg->push_back ( 0 );
+            PutCue ( msg, 1 + i % 20, 0 );
+        }
+
+        if ( kind == 8 )
+        {
+            msg->push_back ( 0 );
+            PutCue ( msg, 1 + i % 4, 0 );
+        }
+
+        if ( kind != 15 )
+            *cue_sum += cue + fract;
+    }
+
+    msg->push_back ( 0xf7 );
+
+    if ( kind != 15 )
+        ++*calls;
+}
+
+int main ( int argc, char **argv )
+{
+    int num_messages = argc > 1 ? atoi ( argv[1] ) : 1000000;
+    const int num_runs = 5;
+
+    // the stream as one buffer of messages, and as sysex events of a show track
+    std::vector<uchar> stream;
+    std::vector<int> offsets ( num_messages + 1 );
+    std::vector<MIDITimedBigMessage> events ( num_messages );
+    unsigned long expected_calls = 0, expected_sum = 0;
+
+    for ( int i = 0; i < num_messages; ++i )
+    {
+        std::vector<uchar> msg;
+        MakeMessage ( i, &msg, &expected_calls, &expected_sum );
+
+        offsets[i] = ( int ) stream.size();
+        stream.insert ( stream.end(), msg.begin(), msg.end() );
+
+        // the sysex of an event holds the data without 0xf0, as MIDIFileRead gives it
+        MIDISystemExclusive sysex ( ( int ) msg.size() );
+
+        for ( size_t k = 1; k < msg.size(); ++k )
+            sysex.PutSysByte ( msg[k] );
+
+        MIDITimedMessage m;
+        m.SetSysEx ( SYSEX_START_N );
+        m.SetTime ( ( MIDIClockTime ) i );
+        events[i] = MIDITimedBigMessage ( m, &sysex );
+    }
+
+    offsets[num_messages] = ( int ) stream.size();
+
+    CountingHandle handle;
+    MIDIShowControlDispatcher dispatcher ( &handle, DEVICE_ID );
+    unsigned long bytes_dispatched = 0, events_dispatched = 0;
+    unsigned long bytes_calls = 0, bytes_sum = 0;
+    auto reset = [&]()
+    {
+        handle.calls = 0;
+        handle.cue_sum = 0;
+    };
+
+    double bytes_ns = BenchBestNs ( num_runs, reset, [&]()
+    {
+        bytes_dispatched = 0;
+
+        for ( int i = 0; i < num_messages; ++i )
+        {
+            if ( dispatcher.Dispatch ( &stream[offsets[i]], offsets[i + 1] - offsets[i] ) )
+                ++bytes_dispatched;
+        }
+    } );
+
+    bytes_calls = handle.calls;
+    bytes_sum = handle.cue_sum;
+
+    double events_ns = BenchBestNs ( num_runs, reset, [&]()
+    {
+        events_dispatched = 0;
+
+        for ( int i = 0; i < num_messages; ++i )
+        {
+            if ( dispatcher.Dispatch ( events[i] ) )
+                ++events_dispatched;
+        }
+    } );
+
+    printf ( "%d messages, %lu for this device, best of %d runs\n", num_messages, expected_calls, num_runs );
+    BenchReport ( "Dispatch ( data, len )", bytes_ns, num_messages );
+    BenchReport ( "Dispatch ( sysex event )", events_ns, num_messages );
+
+    if ( bytes_calls != expected_calls || bytes_sum != expected_sum || bytes_dispatched != expected_calls ||
+            handle.calls != expected_calls || handle.cue_sum != expected_sum || events_dispatched != expected_calls )
+    {
+        fprintf ( stderr, "the handle did not get the expected commands\n" );
+        return 1;
+    }
+
+    return 0;
+}
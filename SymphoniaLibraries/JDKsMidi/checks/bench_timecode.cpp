@@ -0,0 +1,123 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// bench_timecode: converts sample positions to timecode and back with SMPTE, one value at
+// a time, and with the batch functions of MIDITimecode, at 30 fps and 48 kHz.
+//   bench_timecode [num_values]
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/smpte.h"
+#include "jdksmidi/timecode.h"
+
+#include "benchtimer.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace jdksmidi;
+
+int main ( int argc, char **argv )
+{
+    int num_values = argc > 1 ? atoi ( argv[1] ) : 1000000;
+    const int num_runs = 5;
+
+    // sorted positions over almost 6 hours, every 1009 samples so all fields change
+    std::vector<int64_t> samples ( num_values );
+
+    for ( int i = 0; i < num_values; ++i )
+        samples[i] = ( int64_t ) i * 1009;
+
+    SMPTE smpte ( SMPTE_RATE_30, SAMPLE_48000 );
+    MIDITimecode timecode ( 48000 );
+    timecode.SetFrameRate ( SMPTE_RATE_30 );
+
+    std::vector<MIDITimecodeFields> smpte_fields ( num_values );
+    std::vector<MIDITimecodeFields> timecode_fields ( num_values );
+    std::vector<int64_t> smpte_samples ( num_values );
+    std::vector<int64_t> timecode_samples ( num_values );
+    auto nothing = []()
+    {
+    };
+
+    double smpte_to_fields_ns = BenchBestNs ( num_runs, nothing, [&]()
+    {
+        for ( int i = 0; i < num_values; ++i )
+        {
+            MIDITimecodeFields &tc = smpte_fields[i];
+            smpte.SetSampleNumber ( ( ulong ) samples[i] );
+            tc.hours = smpte.GetHours();
+            tc.minutes = smpte.GetMinutes();
+            tc.seconds = smpte.GetSeconds();
+            tc.frames = smpte.GetFrames();
+            tc.sub_frames = smpte.GetSubFrames();
+        }
+    } );
+
+    double timecode_to_fields_ns = BenchBestNs ( num_runs, nothing, [&]()
+    {
+        timecode.SamplesToFields ( &samples[0], &timecode_fields[0], num_values );
+    } );
+
+    double smpte_to_samples_ns = BenchBestNs ( num_runs, nothing, [&]()
+    {
+        for ( int i = 0; i < num_values; ++i )
+        {
+            const MIDITimecodeFields &tc = timecode_fields[i];
+            smpte.SetTime ( ( uchar ) tc.hours, ( uchar ) tc.minutes, ( uchar ) tc.seconds, ( uchar ) tc.frames, ( uchar ) tc.sub_frames );
+            smpte_samples[i] = smpte.GetSampleNumber();
+        }
+    } );
+
+    double timecode_to_samples_ns = BenchBestNs ( num_runs, nothing, [&]()
+    {
+        timecode.FieldsToSamples ( &timecode_fields[0], &timecode_samples[0], num_values );
+    } );
+
+    // 1600 samples per frame and 16 per sub frame, so both have to give the same values
+    int num_different = 0;
+
+    for ( int i = 0; i < num_values; ++i )
+    {
+        const MIDITimecodeFields &a = smpte_fields[i];
+        const MIDITimecodeFields &b = timecode_fields[i];
+
+        if ( a.hours != b.hours || a.minutes != b.minutes || a.seconds != b.seconds ||
+                a.frames != b.frames || a.sub_frames != b.sub_frames ||
+                smpte_samples[i] != timecode_samples[i] )
+        {
+            ++num_different;
+        }
+    }
+
+    printf ( "%d sample positions, best of %d runs\n", num_values, num_runs );
+    BenchReport ( "SMPTE sample to timecode", smpte_to_fields_ns, num_values );
+    BenchReport ( "MIDITimecode::SamplesToFields", timecode_to_fields_ns, num_values );
+    BenchReport ( "SMPTE timecode to sample", smpte_to_samples_ns, num_values );
+    BenchReport ( "MIDITimecode::FieldsToSamples", timecode_to_samples_ns, num_values );
+
+    if ( num_different )
+    {
+        fprintf ( stderr, "%d conversions of SMPTE and MIDITimecode differ\n", num_different );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// benchtimer.h: timing helpers shared by the bench_* programs in checks/
+//
+
+#ifndef JDKSMIDI_CHECKS_BENCHTIMER_H
+#define JDKSMIDI_CHECKS_BENCHTIMER_H
+
+#include <chrono>
+#include <cstdio>
+
+// run prepare() and then work() num_runs times, return the fastest work() time in ns.
+// prepare() is not timed, so every run can start from the same input
+template <class Prepare, class Work>
+double BenchBestNs ( int num_runs, Prepare prepare, Work work )
+{
+    double best = -1.0;
+
+    for ( int run = 0; run < num_runs; ++run )
+    {
+        prepare();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        work();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        double ns = ( double ) std::chrono::duration_cast<std::chrono::nanoseconds> ( end - start ).count();
+
+        if ( best < 0.0 || ns < best )
+            best = ns;
+    }
+
+    return best;
+}
+
+// print one result line: total time, time per item and items per second
+inline void BenchReport ( const char *name, double ns, double num_items )
+{
+    printf ( "%-40s %10.3f ms %8.2f ns/item %10.2f M items/s\n",
+             name, ns * 1e-6, ns / num_items, num_items * 1e3 / ns );
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// check_filewritebuffered: writes the same multitrack with MIDIFileWriteMultiTrack and with
+// MIDIFileWriteMultiTrackBuffered on several threads and fails if the bytes differ.
+//
+// Built by checks/CMakeLists.txt; ctest runs it on the songs in MidiFileParser/Resources.
+//   check_filewritebuffered [file.mid ...]
+// With no arguments only the generated multitrack is checked.
+//
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/multitrack.h"
+#include "jdksmidi/filereadmultitrack.h"
+#include "jdksmidi/filereadblock.h"
+#include "jdksmidi/filewritemultitrack.h"
+#include "jdksmidi/filewritebuffered.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace jdksmidi;
+
+// fill tracks with enough repeated status bytes, meta events and gaps to exercise
+// running status and the delta time encoding, and with every kind of event the
+// encoder writes on its own (tempo, time and key signature, sysex, other meta events)
+static void MakeMultiTrack ( MIDIMultiTrack *tracks )
+{
+    tracks->SetClksPerBeat ( 480 );
+
+    MIDITrack *conductor = tracks->GetTrack ( 0 );
+    MIDITimedBigMessage msg;
+    msg.SetTime ( 0 );
+    msg.SetTempo ( 500000 );
+    conductor->PutEvent ( msg );
+    msg.SetTimeSig ( 4, 2, 24, 8 );
+    conductor->PutEvent ( msg );
+    msg.SetKeySig ( -3, 1 );
+    conductor->PutEvent ( msg );
+    conductor->PutTextEvent ( 0, META_TRACK_NAME, "conductor" );
+    conductor->PutTextEvent ( 1920, META_GENERIC_TEXT, "marker" );
+
+    // non-default metronome values, so swapped bytes can not go unnoticed
+    msg.SetTime ( 3840 );
+    msg.SetTimeSig ( 6, 3, 36, 8 );
+    conductor->PutEvent ( msg );
+    msg.SetTimeSig ( 7, 4, 12, 16 );
+    msg.SetTime ( 7680 );
+    conductor->PutEvent ( msg );
+    msg.SetKeySig ( 2, 0 );
+    conductor->PutEvent ( msg );
+    msg.SetTempo ( 400000 );
+    conductor->PutEvent ( msg );
+
+    for ( int t = 1; t < tracks->GetNumTracks(); ++t )
+    {
+        MIDITrack *track = tracks->GetTrack ( t );
+        unsigned char chan = ( unsigned char ) ( ( t - 1 ) & 0x0f );
+        MIDIClockTime time = 0;
+
+        track->PutTextEvent ( 0, META_TRACK_NAME, "track" );
+
+        // a short meta event which is not text, tempo or signature: the channel prefix
+        MIDISystemExclusive prefix ( 1 );
+        prefix.PutSysByte ( chan );
+        MIDITimedMessage meta;
+        meta.SetTime ( 0 );
+        meta.SetStatus ( META_EVENT );
+        meta.SetMetaType ( META_CHANNEL_PREFIX );
+        track->PutEvent ( meta, &prefix );
+
+        // GM system on, as a sysex event between channel events
+        static const unsigned char gm_on[] = { 0x7e, 0x7f, 0x09, 0x01, 0xf7 };
+        MIDISystemExclusive sysex ( sizeof ( gm_on ) );
+
+        for ( size_t i = 0; i < sizeof ( gm_on ); ++i )
+            sysex.PutSysByte ( gm_on[i] );
+
+        MIDITimedMessage sysex_msg;
+        sysex_msg.SetTime ( 0 );
+        sysex_msg.SetSysEx ( SYSEX_START_N );
+        track->PutEvent ( sysex_msg, &sysex );
+
+        msg.SetTime ( 0 );
+        msg.SetProgramChange ( chan, ( unsigned char ) t );
+        track->PutEvent ( msg );
+
+        for ( int i = 0; i < 200 + t * 10; ++i )
+        {
+            unsigned char note = ( unsigned char ) ( 36 + ( i * 7 + t ) % 60 );
+            msg.SetTime ( time );
+            msg.SetNoteOn ( chan, note, ( unsigned char ) ( 1 + i % 127 ) );
+            track->PutEvent ( msg );
+
+            if ( i % 5 == 0 )
+            {
+                msg.SetControlChange ( chan, 7, ( unsigned char ) ( i % 128 ) );
+                track->PutEvent ( msg );
+            }
+
+            if ( i % 11 == 0 )
+            {
+                msg.SetPitchBend ( chan, ( short ) ( i * 37 % 8192 ) );
+                track->PutEvent ( msg );
+            }
+
+            // sysex in the middle of channel events cancels running status
+            if ( i % 97 == 50 )
+            {
+                sysex_msg.SetTime ( time );
+                track->PutEvent ( sysex_msg, &sysex );
+            }
+
+            // long gaps need multi-byte delta times
+            time += ( i % 13 == 0 ) ? 20000 : 60;
+            msg.SetTime ( time );
+            msg.SetNoteOff ( chan, note, 0 );
+            track->PutEvent ( msg );
+        }
+    }
+}
+
+// return true if both writers produce the same bytes
+static bool CompareWriters ( const MIDIMultiTrack *tracks, const char *name, bool running_status )
+{
+    MIDIFileWriteStreamMemory serial_out;
+    MIDIFileWriteMultiTrack serial_writer ( tracks, &serial_out );
+    serial_writer.UseRunningStatus ( running_status );
+
+    if ( !serial_writer.Write() )
+    {
+        fprintf ( stderr, "%s: MIDIFileWriteMultiTrack failed\n", name );
+        return false;
+    }
+
+    bool ok = true;
+
+    for ( int num_threads = 2; num_threads <= 8; num_threads *= 2 )
+    {
+        MIDIFileWriteStreamMemory buffered_out;
+        MIDIFileWriteMultiTrackBuffered buffered_writer ( tracks, &buffered_out );
+        buffered_writer.UseRunningStatus ( running_status );
+        buffered_writer.SetNumThreads ( num_threads );
+
+        if ( !buffered_writer.Write() )
+        {
+            fprintf ( stderr, "%s: MIDIFileWriteMultiTrackBuffered failed (%d threads)\n", name, num_threads );
+            ok = false;
+            continue;
+        }
+
+        if ( buffered_out.GetLength() != serial_out.GetLength()
+                || memcmp ( buffered_out.GetBuf(), serial_out.GetBuf(), serial_out.GetLength() ) != 0 )
+        {
+            fprintf ( stderr, "%s: output differs (%d threads, running status %s, %lu vs %lu bytes)\n",
+                      name, num_threads, running_status ? "on" : "off",
+                      buffered_out.GetLength(), serial_out.GetLength() );
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool CheckMultiTrack ( const MIDIMultiTrack *tracks, const char *name )
+{
+    bool ok = CompareWriters ( tracks, name, true );
+    ok = CompareWriters ( tracks, name, false ) && ok;
+    printf ( "%s: %s\n", name, ok ? "ok" : "FAILED" );
+    return ok;
+}
+
+int main ( int argc, char **argv )
+{
+    bool ok = true;
+
+    {
+        MIDIMultiTrack tracks ( 17 );
+        MakeMultiTrack ( &tracks );
+        ok = CheckMultiTrack ( &tracks, "generated" ) && ok;
+    }
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        MIDIFileReadStreamBufferedFile stream ( argv[i] );
+
+        if ( !stream.IsValid() )
+        {
+            fprintf ( stderr, "%s: can't open\n", argv[i] );
+            ok = false;
+            continue;
+        }
+
+        MIDIMultiTrack tracks;
+        MIDIFileReadMultiTrack track_loader ( &tracks );
+        MIDIFileReadBlock reader ( &stream, &track_loader );
+
+        if ( !reader.Parse() )
+        {
+            fprintf ( stderr, "%s: can't parse\n", argv[i] );
+            ok = false;
+            continue;
+        }
+
+        ok = CheckMultiTrack ( &tracks, argv[i] ) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
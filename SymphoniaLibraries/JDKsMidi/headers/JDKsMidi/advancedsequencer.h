@@ -123,6 +123,22 @@ public:
 
     void ExtractWarpPositions();
 
+    // offline render: play the whole song as fast as possible with the current mute, solo,
+    // transpose, velocity scale and rechannelize settings of the tracks. tempo events are
+    // scaled by the tempo scale, so the result plays at the current speed. the sequencer
+    // position is restored afterwards; return false while playing
+
+    // events in play order, with track number and time in ms if the vectors are given
+    bool RenderToBuffer ( std::vector< MIDITimedBigMessage > *events,
+                          std::vector< int > *event_tracks = 0,
+                          std::vector< double > *event_times_ms = 0 );
+
+    // events into the same tracks of dest
+    bool RenderToMultiTrack ( MIDIMultiTrack *dest );
+
+    // events into a standard midi file
+    bool RenderToFile ( const char *fname );
+
     bool IsChainMode() const
     {
         return chain_mode;
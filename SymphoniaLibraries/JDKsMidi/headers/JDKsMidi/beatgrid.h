@@ -0,0 +1,150 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_BEATGRID_H
+#define JDKSMIDI_BEATGRID_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/multitrack.h"
+#include "jdksmidi/tempomap.h"
+
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDIBeatGrid;
+
+///
+/// MIDIBeatGrid is built once from the time signature events of a song and its MIDITempoMap,
+/// and keeps the start clock and ms of every measure in arrays, so "where does measure m
+/// start" is an array index and "which measure is at time t" is a binary search, without
+/// playing the song through a MIDISequencer for its beat markers.
+///
+/// Measures and beats are counted from 0, as in MIDISequencer. A beat is a note of the time
+/// signature denominator. A time signature starts a new measure at its time; a time signature
+/// in the middle of a measure makes that measure shorter. Before the first one the time
+/// signature is 4/4. After the end of the music the last time signature goes on, so measures
+/// after the end are computed instead of read from the arrays. The tempo map must stay alive
+/// as long as the grid is used.
+///
+
+class MIDIBeatGrid
+{
+public:
+    struct TimeSig
+    {
+        MIDIClockTime clock;        // start of the first measure with this time signature
+        int first_measure;
+        int numerator;
+        int denominator;
+        MIDIClockTime beat_clocks;
+        MIDIClockTime measure_clocks;
+    };
+
+    MIDIBeatGrid();
+    virtual ~MIDIBeatGrid();
+
+    void Clear();
+
+    // build the grid from the time signatures of all tracks of multitrack and the tempo map
+    // of the same song
+    void Build ( const MIDIMultiTrack *multitrack, const MIDITempoMap &tempo_map );
+
+    // number of measures up to the end of the music
+    int GetNumMeasures() const
+    {
+        return ( int ) measure_clock.size() - 1;
+    }
+
+    MIDIClockTime GetMeasureStartClock ( int measure ) const
+    {
+        if ( measure >= 0 && measure < ( int ) measure_clock.size() )
+            return measure_clock[measure];
+
+        return ComputeMeasureStartClock ( measure );
+    }
+
+    // ms at tempo scale 100%
+    double GetMeasureStartMs ( int measure ) const
+    {
+        if ( measure >= 0 && measure < ( int ) measure_ms.size() )
+            return measure_ms[measure];
+
+        return tempo_map ? tempo_map->ClockToMs ( ComputeMeasureStartClock ( measure ) ) : 0.0;
+    }
+
+    // measure at clock
+    int GetMeasureAtClock ( MIDIClockTime clock ) const;
+
+    // measure at ms, at tempo scale 100%
+    int GetMeasureAtMs ( double ms ) const;
+
+    // measure and beat at clock, and the clocks after the beat start
+    void ClockToMeasureBeat ( MIDIClockTime clock, int *measure, int *beat, MIDIClockTime *beat_offset = 0 ) const;
+
+    MIDIClockTime MeasureBeatToClock ( int measure, int beat = 0 ) const;
+
+    // the time signature of measure
+    const TimeSig &GetTimeSigOfMeasure ( int measure ) const
+    {
+        return timesigs[FindTimeSigOfMeasure ( measure )];
+    }
+
+    const TimeSig &GetTimeSigAtClock ( MIDIClockTime clock ) const
+    {
+        return timesigs[FindTimeSigOfClock ( clock )];
+    }
+
+    int GetNumTimeSigs() const
+    {
+        return ( int ) timesigs.size();
+    }
+
+    const TimeSig &GetTimeSig ( int n ) const
+    {
+        return timesigs[n];
+    }
+
+protected:
+    MIDIClockTime ComputeMeasureStartClock ( int measure ) const
+    {
+        if ( measure < 0 )
+            measure = 0;
+
+        const TimeSig &ts = GetTimeSigOfMeasure ( measure );
+        return ts.clock + ( MIDIClockTime ) ( measure - ts.first_measure ) * ts.measure_clocks;
+    }
+
+    void AddTimeSig ( MIDIClockTime clock, int numerator, int denominator );
+
+    int FindTimeSigOfClock ( MIDIClockTime clock ) const;
+    int FindTimeSigOfMeasure ( int measure ) const;
+
+    const MIDITempoMap *tempo_map;
+    int clks_per_beat;
+
+    std::vector<TimeSig> timesigs;          // sorted by clock, never empty
+    std::vector<MIDIClockTime> measure_clock; // start of each measure and the end of the last
+    std::vector<double> measure_ms;
+};
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_DRIVERRECORDER_H
+#define JDKSMIDI_DRIVERRECORDER_H
+
+#include "jdksmidi/driver.h"
+#include "jdksmidi/tempomap.h"
+#include "jdksmidi/timingengine.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDIDriverRecorder;
+class MIDIDriverRecorderBenchmark;
+
+///
+/// MIDIDriverRecorderEntry is one message sent out by a MIDIDriverRecorder, with the time
+/// it should have been sent at (from its midi clock and the tempo map) and the time it was.
+///
+
+struct MIDIDriverRecorderEntry
+{
+    unsigned char status;
+    unsigned char byte1;
+    unsigned char byte2;
+    MIDIClockTime clock;
+    int64_t intended_ns;
+    int64_t actual_ns;
+
+    int64_t GetLatenessNs() const
+    {
+        return actual_ns - intended_ns;
+    }
+};
+
+///
+/// MIDIDriverRecorderStats is the summary of the entries of a MIDIDriverRecorder. Lateness is
+/// the actual minus the intended send time; it is negative for messages sent early.
+///
+
+struct MIDIDriverRecorderStats
+{
+    unsigned long num_messages;
+    unsigned long num_dropped;
+    int64_t min_lateness_ns;
+    int64_t p50_lateness_ns;
+    int64_t p99_lateness_ns;
+    int64_t max_lateness_ns;
+    double mean_lateness_ns;
+    double messages_per_second; // messages per second of send time, or of wall time for a benchmark
+};
+
+///
+/// MIDIDriverRecorder is a MIDIDriver without hardware, which records every message given to
+/// HardwareMsgOut() in a ring of entries allocated once in the constructor, so recording does
+/// not allocate and works on any platform. When the ring is full the oldest entries are
+/// overwritten and counted as dropped.
+///
+/// The actual send time is read from a MIDITimingClock, relative to an origin; without a clock
+/// it is the sys_time of the last TimeTick(). The intended time needs a MIDITempoMap of the song
+/// which is played; without one it is 0.
+///
+/// The entries may only be read while nothing calls HardwareMsgOut().
+///
+
+class MIDIDriverRecorder : public MIDIDriver
+{
+public:
+    MIDIDriverRecorder ( int queue_size, int ring_size );
+    virtual ~MIDIDriverRecorder();
+
+    virtual void Reset();
+
+    virtual bool HardwareMsgOut ( const MIDITimedBigMessage &msg );
+
+    virtual void TimeTick ( unsigned long sys_time );
+
+    // actual send times are clock->GetTimeNs() - origin_ns
+    void SetTimeSource ( const MIDITimingClock *clock_, int64_t origin_ns_ )
+    {
+        clock = clock_;
+        origin_ns = origin_ns_;
+    }
+
+    // intended send times are tempo_map->ClockToMs ( msg time ) at tempo scale
+    // tempo_scale (1.0 = 100%), plus offset_ns
+    void SetTempoMap ( const MIDITempoMap *tempo_map_, double tempo_scale_ = 1.0, int64_t offset_ns = 0 )
+    {
+        tempo_map = tempo_map_;
+        tempo_scale = tempo_scale_;
+        intended_offset_ns = offset_ns;
+    }
+
+    // forget all entries
+    void ClearEntries()
+    {
+        first_entry = 0;
+        num_entries = 0;
+        num_dropped = 0;
+    }
+
+    int GetRingSize() const
+    {
+        return ( int ) ring.size();
+    }
+
+    int GetNumEntries() const
+    {
+        return num_entries;
+    }
+
+    // entry n, 0 is the oldest one
+    const MIDIDriverRecorderEntry &GetEntry ( int n ) const
+    {
+        int i = first_entry + n;
+
+        if ( i >= ( int ) ring.size() )
+            i -= ( int ) ring.size();
+
+        return ring[i];
+    }
+
+    unsigned long GetNumDropped() const
+    {
+        return num_dropped;
+    }
+
+    // summary of the entries, return false if there are none
+    bool GetStats ( MIDIDriverRecorderStats *stats ) const;
+
+protected:
+    std::vector<MIDIDriverRecorderEntry> ring;
+    int first_entry;
+    int num_entries;
+    unsigned long num_dropped;
+
+    const MIDITimingClock *clock;
+    int64_t origin_ns;
+    unsigned long last_sys_time;
+
+    const MIDITempoMap *tempo_map;
+    double tempo_scale;
+    int64_t intended_offset_ns;
+};
+
+///
+/// MIDIDriverRecorderBenchmark plays a midi file through a MIDIManager into a
+/// MIDIDriverRecorder, ticked by a MIDITimingEngine, and gives the stats of the recording.
+/// With a MIDITimingSteadyClock this measures the scheduling jitter of the real time path;
+/// with a MIDITimingVirtualClock the song is played as fast as possible, which measures the
+/// throughput of sequencer, manager and driver, so messages_per_second is measured with the
+/// wall time of the run.
+///
+
+class MIDIDriverRecorderBenchmark
+{
+public:
+    MIDIDriverRecorderBenchmark ( MIDITimingClock *clock_, int64_t period_ns_ = 1000000, int ring_size_ = 1 << 20 );
+    virtual ~MIDIDriverRecorderBenchmark();
+
+    // play the whole file, return false if it can not be read
+    bool Run ( const char *fname, MIDIDriverRecorderStats *stats );
+
+    // play a song which is loaded already
+    bool Run ( const MIDIMultiTrack *tracks, MIDIDriverRecorderStats *stats );
+
+    // print stats to f, one line
+    static void Print ( FILE *f, const char *name, const MIDIDriverRecorderStats &stats );
+
+protected:
+    MIDITimingClock *clock;
+    int64_t period_ns;
+    int ring_size;
+};
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_EDITTRACKINDEXED_H
+#define JDKSMIDI_EDITTRACKINDEXED_H
+
+#include "jdksmidi/track.h"
+#include "jdksmidi/process.h"
+#include "jdksmidi/edittrack.h"
+
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDITrackTimeIndex;
+class MIDIEditTrackIndexed;
+
+///
+/// MIDITrackTimeIndex is a directory of the event times of a MIDITrack in blocks of
+/// block_size events. For each block it keeps the highest time up to the end of the block,
+/// so the first event at or after a time is found with a binary search over the blocks and
+/// a scan of one block, instead of a walk from event 0. The track must be sorted by time.
+///
+
+class MIDITrackTimeIndex
+{
+public:
+    explicit MIDITrackTimeIndex ( const MIDITrack *track_ = 0, int block_size_ = 64 );
+    virtual ~MIDITrackTimeIndex();
+
+    void SetTrack ( const MIDITrack *track_ )
+    {
+        track = track_;
+        Build();
+    }
+
+    // index the whole track
+    void Build()
+    {
+        block_max.clear();
+        Update ( 0 );
+    }
+
+    // index again from event event_num on, after times from there changed or events were added
+    void Update ( int event_num );
+
+    // number of first event with time >= time, or the number of events if there is none
+    int FindFirstAtOrAfter ( MIDIClockTime time ) const;
+
+    int GetBlockSize() const
+    {
+        return block_size;
+    }
+
+    int GetNumBlocks() const
+    {
+        return ( int ) block_max.size();
+    }
+
+protected:
+    const MIDITrack *track;
+    int block_size;
+    std::vector<MIDIClockTime> block_max; // highest time up to the end of each block
+};
+
+///
+/// MIDIEditTrackIndexed does the range edits of MIDIEditTrack with a MIDITrackTimeIndex, so an
+/// edit of [start, end) finds start with a binary search and only touches the events of the
+/// range (and, for Insert and Delete, the events after it, whose times move). Erased events
+/// are made NoOp in place; they are dropped at the next rebuild or Compact().
+///
+/// Edits which change the order of events (PutEvent() and Shift() with a matcher) rebuild the
+/// track. Between BeginBatch() and EndBatch() they are only collected and the track is rebuilt
+/// once, at EndBatch(); until then the other edits do not see them.
+///
+/// The track must be sorted by time, and must not be changed by others while it is edited, or
+/// Reindex() must be called afterwards.
+///
+
+class MIDIEditTrackIndexed
+{
+public:
+    explicit MIDIEditTrackIndexed ( MIDITrack *track_, int block_size = 64 );
+    virtual ~MIDIEditTrackIndexed();
+
+    // index the track again after it was changed by others
+    void Reindex()
+    {
+        index.Build();
+    }
+
+    const MIDITrackTimeIndex &GetIndex() const
+    {
+        return index;
+    }
+
+    //
+    // Process applies a MIDI process to all events from start_time to before end_time that are
+    // matched (all if match is 0). Events the process rejects are erased. The process must
+    // not change the times
+    //
+    void Process (
+        MIDIClockTime start_time,
+        MIDIClockTime end_time,
+        MIDIProcessor *process,
+        MIDIEditTrackEventMatcher *match = 0
+    );
+
+    //
+    // Erase erases the matched events from start to before end, return number of erased events.
+    // notes going over start or end are not changed, as in the jagged erase of MIDIEditTrack
+    //
+    int Erase (
+        MIDIClockTime start,
+        MIDIClockTime end,
+        MIDIEditTrackEventMatcher *match = 0
+    );
+
+    //
+    // Delete erases all events from start to before end and moves the later events
+    // back by end - start
+    //
+    void Delete (
+        MIDIClockTime start,
+        MIDIClockTime end
+    );
+
+    //
+    // Insert moves the events at or after start by length
+    //
+    void Insert (
+        MIDIClockTime start,
+        MIDIClockTime length
+    );
+
+    //
+    // Shift moves the matched events by offset (all if match is 0), times before 0 become 0.
+    // Without matcher the order stays and the track is changed in place
+    //
+    void Shift (
+        signed long offset,
+        MIDIEditTrackEventMatcher *match = 0
+    );
+
+    // add a new event at its time
+    bool PutEvent ( const MIDITimedBigMessage &msg );
+
+    // collect the edits which need a rebuild until EndBatch(). batches can be nested
+    void BeginBatch()
+    {
+        ++batch_level;
+    }
+
+    // rebuild the track with the collected edits when the outermost batch ends,
+    // return false if the track had no space
+    bool EndBatch();
+
+    bool IsInBatch() const
+    {
+        return batch_level > 0;
+    }
+
+    // drop the NoOp events, return false if the track had no space
+    bool Compact()
+    {
+        return Rebuild();
+    }
+
+protected:
+    // move events from event_num on by offset, which keeps the order
+    void ShiftFrom ( int event_num, signed long offset );
+
+    // rebuild the track now if no batch is open
+    bool RebuildIfNotInBatch()
+    {
+        return batch_level > 0 || Rebuild();
+    }
+
+    // make the track of its events which are not NoOp and the pending events, in time order
+    bool Rebuild();
+
+    MIDITrack *track;
+    MIDITrackTimeIndex index;
+    int batch_level;
+    std::vector<MIDITimedBigMessage> pending;
+};
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_FILEREADBLOCK_H
+#define JDKSMIDI_FILEREADBLOCK_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/file.h"
+#include "jdksmidi/fileread.h"
+
+namespace jdksmidi
+{
+
+class MIDIFileReadStreamBlock;
+class MIDIFileReadStreamMemory;
+class MIDIFileReadStreamBufferedFile;
+class MIDIFileReadBlock;
+
+///
+/// A MIDIFileReadStreamBlock is a read stream which can hand out a whole block of
+/// the file at once. MIDIFileReadBlock uses it to fetch each MTrk chunk with one
+/// call and decode the events straight from memory instead of calling ReadChar()
+/// for every byte.
+///
+
+class MIDIFileReadStreamBlock : public MIDIFileReadStream
+{
+public:
+    MIDIFileReadStreamBlock()
+    {
+    }
+
+    virtual ~MIDIFileReadStreamBlock()
+    {
+    }
+
+    // return pointer to the next len bytes and skip them, or 0 if less than len bytes left.
+    // the pointer stays valid while the stream object is alive
+    virtual const unsigned char *ReadBlock ( unsigned long len ) = 0;
+
+    // return current read position, from start of the stream
+    virtual unsigned long GetPosition() const = 0;
+};
+
+///
+/// MIDIFileReadStreamMemory reads a midi file which is already in memory, for example
+/// the bytes of a Unity TextAsset. The buffer is not copied, it must stay alive as long
+/// as the stream and anything parsed from it that refers to the stream data.
+///
+
+class MIDIFileReadStreamMemory : public MIDIFileReadStreamBlock
+{
+public:
+    MIDIFileReadStreamMemory ( const unsigned char *buf_, unsigned long len_ )
+        : buf ( buf_ ), len ( buf_ ? len_ : 0 ), pos ( 0 )
+    {
+    }
+
+    virtual ~MIDIFileReadStreamMemory()
+    {
+    }
+
+    virtual void Rewind()
+    {
+        pos = 0;
+    }
+
+    virtual int ReadChar()
+    {
+        return ( pos < len ) ? buf[pos++] : -1;
+    }
+
+    virtual const unsigned char *ReadBlock ( unsigned long block_len )
+    {
+        if ( block_len > len - pos )
+            return 0;
+
+        const unsigned char *p = buf + pos;
+        pos += block_len;
+        return p;
+    }
+
+    virtual unsigned long GetPosition() const
+    {
+        return pos;
+    }
+
+    bool IsValid() const
+    {
+        return buf != 0;
+    }
+
+    const unsigned char *GetBuf() const
+    {
+        return buf;
+    }
+
+    unsigned long GetLength() const
+    {
+        return len;
+    }
+
+protected:
+    MIDIFileReadStreamMemory()
+        : buf ( 0 ), len ( 0 ), pos ( 0 )
+    {
+    }
+
+    void SetBuffer ( const unsigned char *buf_, unsigned long len_ )
+    {
+        buf = buf_;
+        len = buf_ ? len_ : 0;
+        pos = 0;
+    }
+
+private:
+    const unsigned char *buf;
+    unsigned long len;
+    unsigned long pos;
+};
+
+///
+/// MIDIFileReadStreamBufferedFile pulls the whole file into memory with one fread()
+/// and then works as MIDIFileReadStreamMemory.
+///
+
+class MIDIFileReadStreamBufferedFile : public MIDIFileReadStreamMemory
+{
+public:
+    explicit MIDIFileReadStreamBufferedFile ( const char *fname );
+
+#ifdef WIN32
+    explicit MIDIFileReadStreamBufferedFile ( const wchar_t *fname );
+#endif
+
+    // read the rest of the opened file f_, the file is not closed
+    explicit MIDIFileReadStreamBufferedFile ( FILE *f_ );
+
+    virtual ~MIDIFileReadStreamBufferedFile();
+
+private:
+    // read f from current position to end of file, return false on read error
+    bool Load ( FILE *f );
+
+    std::vector<unsigned char> data;
+};
+
+///
+/// MIDIFileReadBlock parses a midi file like MIDIFileRead and gives the same events to
+/// the MIDIFileEvents handler. The header chunk is read by MIDIFileRead, but every MTrk
+/// chunk is fetched with one ReadBlock() call and decoded from memory by ReadTrackBlock().
+/// Meta event and unsplit sysex data is given to the handler as a pointer into the block,
+/// so handlers must not change it.
+///
+
+class MIDIFileReadBlock : public MIDIFileRead
+{
+public:
+    MIDIFileReadBlock (
+        MIDIFileReadStreamBlock *input_stream_,
+        MIDIFileEvents *event_handler_,
+        unsigned long max_msg_len = 8192
+    );
+    virtual ~MIDIFileReadBlock();
+
+    // return false if not enough number of tracks or events in any track
+    virtual bool Parse();
+
+    // decode the body of one MTrk chunk (without the chunk id and length) as track trk,
+    // return false if the handler had no space for any event
+    bool ReadTrackBlock ( int trk, const unsigned char *data, unsigned long len );
+
+    // call it after Parse(): return true if file contain event(s) with running status
+    bool UsedRunningStatus() const
+    {
+        return block_used_running_status;
+    }
+
+protected:
+    // read the next chunk header from the stream, skipping unknown chunks.
+    // return pointer to the MTrk chunk body or 0 if there is no more MTrk chunk
+    const unsigned char *ReadTrackChunk ( unsigned long *len );
+
+    // read a variable length number from p, return false if it runs past end
+    static bool ReadBlockVariableNum ( const unsigned char **p, const unsigned char *end, unsigned long *num );
+
+    MIDIFileReadStreamBlock *block_stream;
+    MIDIFileEvents *block_event_handler;
+
+    bool block_used_running_status;
+};
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_FILEREADLAZY_H
+#define JDKSMIDI_FILEREADLAZY_H
+
+#include "jdksmidi/filereadblock.h"
+#include "jdksmidi/filereadmultitrack.h"
+#include "jdksmidi/multitrack.h"
+
+#include <string>
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDIFileReadLazy;
+
+///
+/// MIDIFileReadLazy reads a midi file in two levels. Index() reads the header, finds every
+/// MTrk chunk and scans it for the meta events only (track name, tempo, time signature and
+/// the time of the last event), without making any event. That is enough to show a song in
+/// a browser: name, number of tracks, duration and tempo. The events of a track are decoded
+/// into the MIDIMultiTrack the first time the track is asked for with GetTrack().
+///
+/// The chunks are not copied, so the stream (a MIDIFileReadStreamMemory or
+/// MIDIFileReadStreamBufferedFile) must stay alive as long as tracks may be decoded.
+/// A format 0 file has one chunk for all tracks, so any track decodes the whole song.
+///
+
+class MIDIFileReadLazy : public MIDIFileReadBlock
+{
+public:
+    struct ChunkInfo
+    {
+        const unsigned char *data;   // body of the MTrk chunk, in the stream
+        unsigned long len;
+        MIDIClockTime end_clock;     // time of last event which is not end of track
+        std::string name;            // first track name meta event
+        bool decoded;
+    };
+
+    struct TempoChange
+    {
+        MIDIClockTime clock;
+        unsigned long us_per_quarter;
+    };
+
+    MIDIFileReadLazy (
+        MIDIFileReadStreamBlock *input_stream_,
+        MIDIMultiTrack *multitrack_,
+        unsigned long max_msg_len = 8192
+    );
+    virtual ~MIDIFileReadLazy();
+
+    // read header and index the chunks, return false if the file is not valid.
+    // the multitrack is cleared and gets its tracks, but they stay empty
+    bool Index();
+
+    // Index() and decode all tracks
+    virtual bool Parse();
+
+    // track trk of the multitrack, decoded first if it is not yet. 0 if there is no track trk
+    MIDITrack *GetTrack ( int trk );
+
+    // decode the chunk of track trk, return false on error
+    bool DecodeTrack ( int trk );
+
+    bool DecodeAllTracks();
+
+    bool IsTrackDecoded ( int trk ) const
+    {
+        int chunk = GetChunkOfTrack ( trk );
+        return chunk >= 0 && chunk_info[chunk].decoded;
+    }
+
+    int GetNumChunks() const
+    {
+        return ( int ) chunk_info.size();
+    }
+
+    const ChunkInfo &GetChunkInfo ( int chunk ) const
+    {
+        return chunk_info[chunk];
+    }
+
+    // number of chunk which holds track trk, or -1
+    int GetChunkOfTrack ( int trk ) const
+    {
+        if ( GetFormat() == 0 )
+            trk = 0;
+
+        return ( trk >= 0 && trk < ( int ) chunk_info.size() ) ? trk : -1;
+    }
+
+    const char *GetChunkName ( int chunk ) const
+    {
+        return chunk_info[chunk].name.c_str();
+    }
+
+    // tempo changes of the conductor track (the first chunk), sorted by time
+    int GetNumTempoChanges() const
+    {
+        return ( int ) tempo_changes.size();
+    }
+
+    const TempoChange &GetTempoChange ( int n ) const
+    {
+        return tempo_changes[n];
+    }
+
+    // tempo at time 0 in beats per minute
+    double GetStartTempoBPM() const;
+
+    // first time signature at time 0, 4/4 if there is none
+    int GetTimeSigNumerator() const
+    {
+        return timesig_numerator;
+    }
+
+    int GetTimeSigDenominator() const
+    {
+        return timesig_denominator;
+    }
+
+    // time of last event which is not end of track
+    MIDIClockTime GetMusicEndClock() const
+    {
+        return music_end_clock;
+    }
+
+    // duration up to the last event which is not end of track, at tempo scale 100%
+    double GetMusicDurationInMilliseconds() const;
+
+protected:
+    // scan the meta events of chunk into info, the tempo changes only if it is the conductor
+    bool ScanChunk ( ChunkInfo *info, bool conductor );
+
+    MIDIFileReadMultiTrack track_loader;
+    MIDIMultiTrack *multitrack;
+
+    std::vector<ChunkInfo> chunk_info;
+    std::vector<TempoChange> tempo_changes;
+    int timesig_numerator;
+    int timesig_denominator;
+    bool timesig_found;
+    MIDIClockTime music_end_clock;
+};
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_FILEREADSYSEX_H
+#define JDKSMIDI_FILEREADSYSEX_H
+
+#include "jdksmidi/filereadmultitrack.h"
+#include "jdksmidi/sysexpool.h"
+
+namespace jdksmidi
+{
+
+class MIDIFileReadMultiTrackSysEx;
+
+///
+/// MIDIFileReadMultiTrackSysEx is a MIDIFileReadMultiTrack with a choice of what is done with
+/// the data of sysex events:
+///
+///  SYSEX_COPY      every event gets its own MIDISystemExclusive, as MIDIFileReadMultiTrack
+///  SYSEX_SKIP      sysex events are not loaded
+///  SYSEX_REFERENCE the event keeps only the offset and length of the data in the source
+///                  buffer (the memory of a MIDIFileReadStreamMemory read by MIDIFileReadBlock),
+///                  so nothing is allocated or copied. the buffer must stay alive
+///  SYSEX_INTERN    the data goes to a MIDISysExPool, equal data is stored once
+///
+/// A referenced or interned event is a NoOp service message, so it is never written to a file
+/// or sent to a driver as a sysex without data. Its sysex status is in data_length, its
+/// reference number (offset or blob number) in byte1-byte4, its length in byte5-byte6 and
+/// the top bit of byte6 is set for a blob number.
+/// GetSysExData() finds the data of any sysex event or reference. Before the multitrack is
+/// written to a file or sent to a driver, ResolveSysEx() must make the references sysex events
+/// with their own data again. MIDITrack::ClearAndMerge() drops NoOp events, so the tracks
+/// must also be resolved before they are merged.
+/// Data which can not be referenced (not in the source buffer, or longer than 32767 bytes)
+/// is interned, or copied if there is no pool.
+///
+
+class MIDIFileReadMultiTrackSysEx : public MIDIFileReadMultiTrack
+{
+public:
+    enum SysExMode
+    {
+        SYSEX_COPY = 0,
+        SYSEX_SKIP,
+        SYSEX_REFERENCE,
+        SYSEX_INTERN
+    };
+
+    MIDIFileReadMultiTrackSysEx ( MIDIMultiTrack *mlttrk, SysExMode mode_ = SYSEX_COPY, MIDISysExPool *pool_ = 0 );
+    virtual ~MIDIFileReadMultiTrackSysEx();
+
+    void SetSysExMode ( SysExMode mode_ )
+    {
+        mode = mode_;
+    }
+
+    SysExMode GetSysExMode() const
+    {
+        return mode;
+    }
+
+    // buffer the file is read from, for SYSEX_REFERENCE
+    void SetSource ( const unsigned char *source_buf_, unsigned long source_len_ )
+    {
+        source_buf = source_buf_;
+        source_len = source_len_;
+    }
+
+    // pool for SYSEX_INTERN, and for data which can not be referenced
+    void SetPool ( MIDISysExPool *pool_ )
+    {
+        pool = pool_;
+    }
+
+    virtual bool mf_sysex ( MIDIClockTime time, int type, int len, unsigned char *s );
+
+    // number of sysex events which were skipped, referenced or interned instead of copied
+    unsigned long GetNumSkipped() const
+    {
+        return num_skipped;
+    }
+
+    unsigned long GetNumReferenced() const
+    {
+        return num_referenced;
+    }
+
+    unsigned long GetNumInterned() const
+    {
+        return num_interned;
+    }
+
+    // return true if msg refers to sysex data in the source or pool
+    static bool IsSysExRef ( const MIDITimedBigMessage &msg )
+    {
+        return msg.IsNoOp() && ( msg.GetDataLength() == SYSEX_START_N || msg.GetDataLength() == SYSEX_START_A );
+    }
+
+    // sysex status of the referenced event
+    static unsigned char GetSysExRefType ( const MIDITimedBigMessage &msg )
+    {
+        return msg.GetDataLength();
+    }
+
+    static unsigned long GetSysExRefNumber ( const MIDITimedBigMessage &msg )
+    {
+        return ( unsigned long ) msg.GetByte1() | ( ( unsigned long ) msg.GetByte2() << 8 )
+               | ( ( unsigned long ) msg.GetByte3() << 16 ) | ( ( unsigned long ) msg.GetByte4() << 24 );
+    }
+
+    static int GetSysExRefLength ( const MIDITimedBigMessage &msg )
+    {
+        return msg.GetByte5() | ( ( msg.GetByte6() & 0x7f ) << 8 );
+    }
+
+    // true if the reference number is a blob number in the pool, false for an offset in the source
+    static bool IsSysExRefInterned ( const MIDITimedBigMessage &msg )
+    {
+        return ( msg.GetByte6() & 0x80 ) != 0;
+    }
+
+    // data of sysex event or reference msg loaded by this reader, 0 if msg has none
+    const unsigned char *GetSysExData ( const MIDITimedBigMessage &msg, int *len ) const;
+
+    // make all references of multitrack sysex events with their own MIDISystemExclusive,
+    // return number of events changed
+    int ResolveSysEx ( MIDIMultiTrack *multitrack ) const;
+
+protected:
+    enum
+    {
+        MAX_REF_LENGTH = 0x7fff
+    };
+
+    // put a sysex event which refers to data number ref_num of length len
+    bool AddSysExRef ( MIDIClockTime time, int type, unsigned long ref_num, int len, bool interned );
+
+    SysExMode mode;
+    const unsigned char *source_buf;
+    unsigned long source_len;
+    MIDISysExPool *pool;
+
+    unsigned long num_skipped;
+    unsigned long num_referenced;
+    unsigned long num_interned;
+};
+
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_FILEWRITEBUFFERED_H
+#define JDKSMIDI_FILEWRITEBUFFERED_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/sysex.h"
+#include "jdksmidi/file.h"
+#include "jdksmidi/filewrite.h"
+#include "jdksmidi/multitrack.h"
+
+namespace jdksmidi
+{
+
+class MIDIFileWriteStreamBlock;
+class MIDIFileWriteStreamMemory;
+class MIDIFileWriteStreamBlockFile;
+class MIDIFileTrackEncoder;
+class MIDIFileWriteMultiTrackBuffered;
+
+///
+/// A MIDIFileWriteStreamBlock is a write stream which can take a whole block of the file
+/// at once. MIDIFileWriteMultiTrackBuffered only writes forward with WriteBlock(), so the
+/// target does not need to support Seek() (pipes, memory).
+///
+
+class MIDIFileWriteStreamBlock : public MIDIFileWriteStream
+{
+public:
+    MIDIFileWriteStreamBlock()
+    {
+    }
+
+    virtual ~MIDIFileWriteStreamBlock()
+    {
+    }
+
+    // return false on write error
+    virtual bool WriteBlock ( const unsigned char *buf, unsigned long len ) = 0;
+};
+
+///
+/// MIDIFileWriteStreamMemory collects the midi file in memory, so nothing touches the
+/// disk until SaveToFile() is called.
+///
+
+class MIDIFileWriteStreamMemory : public MIDIFileWriteStreamBlock
+{
+public:
+    MIDIFileWriteStreamMemory();
+    virtual ~MIDIFileWriteStreamMemory();
+
+    long Seek ( long pos, int whence = SEEK_SET );
+    int WriteChar ( int c );
+    bool WriteBlock ( const unsigned char *buf, unsigned long len );
+
+    void Clear()
+    {
+        data.clear();
+        pos = 0;
+    }
+
+    const unsigned char *GetBuf() const
+    {
+        return data.empty() ? 0 : &data[0];
+    }
+
+    unsigned long GetLength() const
+    {
+        return ( unsigned long ) data.size();
+    }
+
+    // write the collected file to disk, return false on error
+    bool SaveToFile ( const char *fname ) const;
+
+protected:
+    std::vector<unsigned char> data;
+    unsigned long pos;
+};
+
+///
+/// MIDIFileWriteStreamBlockFile writes to an opened FILE (which may be a pipe), or to
+/// a file opened by name which is closed by the destructor.
+///
+
+class MIDIFileWriteStreamBlockFile : public MIDIFileWriteStreamBlock
+{
+public:
+    explicit MIDIFileWriteStreamBlockFile ( FILE *f_ );
+    explicit MIDIFileWriteStreamBlockFile ( const char *fname );
+
+#ifdef WIN32
+    explicit MIDIFileWriteStreamBlockFile ( const wchar_t *fname );
+#endif
+
+    virtual ~MIDIFileWriteStreamBlockFile();
+
+    bool IsValid() const
+    {
+        return f != 0;
+    }
+
+    long Seek ( long pos, int whence = SEEK_SET );
+    int WriteChar ( int c );
+    bool WriteBlock ( const unsigned char *buf, unsigned long len );
+
+protected:
+    FILE *f;
+    bool close_file;
+};
+
+///
+/// MIDIFileTrackEncoder encodes the events of one track into a memory buffer in midi
+/// file format (delta times, running status, meta and sysex events), without the MTrk
+/// chunk header. When the track is done its length is known, so the chunk header can
+/// be written before the data and no seek back is needed.
+///
+
+class MIDIFileTrackEncoder
+{
+public:
+    MIDIFileTrackEncoder();
+    virtual ~MIDIFileTrackEncoder();
+
+    // forget all encoded data and start a new track
+    void Reset();
+
+    // encode all track events up to the first end of track event, then end of track;
+    // track can be 0 for an empty track
+    void EncodeTrack ( const MIDITrack *track );
+
+    void WriteEvent ( const MIDITimedBigMessage &m );
+    void WriteMetaEvent ( MIDIClockTime time, unsigned char type, const unsigned char *data, unsigned long length );
+    void WriteSystemExclusiveEvent ( MIDIClockTime time, unsigned char type, const unsigned char *data, unsigned long length );
+
+    // write end of track at time (or at the last event time, if it is later), only once per track
+    void WriteEndOfTrack ( MIDIClockTime time );
+
+    // false argument disable use running status in midi file (true on default)
+    void UseRunningStatus ( bool use )
+    {
+        use_running_status = use;
+    }
+
+    const unsigned char *GetBuf() const
+    {
+        return buf.empty() ? 0 : &buf[0];
+    }
+
+    unsigned long GetLength() const
+    {
+        return ( unsigned long ) buf.size();
+    }
+
+protected:
+    void WriteDeltaTime ( MIDIClockTime time );
+    void WriteVariableNum ( unsigned long n );
+
+    void WriteCharacter ( unsigned char c )
+    {
+        buf.push_back ( c );
+    }
+
+    std::vector<unsigned char> buf;
+
+    bool use_running_status; // true on default
+    bool within_track;
+    MIDIClockTime track_time;
+    unsigned char running_status;
+};
+
+///
+/// MIDIFileWriteMultiTrackBuffered writes a MIDIMultiTrack as a standard midi file like
+/// MIDIFileWriteMultiTrack, but every track is first encoded into its own buffer by a
+/// MIDIFileTrackEncoder. Then the whole file is written with a few large WriteBlock() calls.
+/// The tracks are independent of each other, so they are encoded by several worker threads;
+/// the output is the same as with one thread.
+///
+
+class MIDIFileWriteMultiTrackBuffered
+{
+public:
+
+    MIDIFileWriteMultiTrackBuffered (
+        const MIDIMultiTrack *mlt_,
+        MIDIFileWriteStreamBlock *strm_
+    );
+
+    virtual ~MIDIFileWriteMultiTrackBuffered();
+
+    bool Write ( int num_tracks, int division );
+
+    bool Write ( int num_tracks )
+    {
+        return Write ( num_tracks, multitrack->GetClksPerBeat() );
+    }
+    bool Write()
+    {
+        return Write ( multitrack->GetNumTracks(), multitrack->GetClksPerBeat() );
+    }
+
+    // false argument disable use running status in midi file (true on default)
+    void UseRunningStatus ( bool use )
+    {
+        use_running_status = use;
+    }
+
+    // number of threads used to encode the tracks, 0 (default) for one thread per cpu core
+    void SetNumThreads ( int num )
+    {
+        num_threads = num;
+    }
+
+protected:
+    // encode tracks 0...num_tracks-1 into encoders
+    void EncodeTracks ( int num_tracks );
+
+    const MIDIMultiTrack *multitrack;
+    MIDIFileWriteStreamBlock *out_stream;
+    bool use_running_status;
+    int num_threads;
+
+    std::vector<MIDIFileTrackEncoder> encoders;
+};
+
+}
+
+#endif
@@ -0,0 +1,227 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_KEYSIGTIMELINE_H
+#define JDKSMIDI_KEYSIGTIMELINE_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/multitrack.h"
+
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDIKeySpellingTable;
+class MIDIKeySignatureTimeline;
+
+///
+/// MIDINoteSpelling is the name of one midi note in a key: letter, accidental and octave
+/// (middle C, note 60, is C4), its scale degree and its distance from the tonic.
+///
+
+struct MIDINoteSpelling
+{
+    char name[4];              // letter and accidental, as "C", "F#", "Bb", "Fx" or "Ebb"
+    signed char octave;        // octave of the letter, B#3 is note 60
+    unsigned char letter;      // 0-6 for C D E F G A B
+    signed char accidental;    // -2 double flat ... 2 double sharp
+    unsigned char degree;      // scale degree of the letter, 1 = tonic ... 7
+    unsigned char interval;    // semitones above the tonic, 0-11
+    bool in_scale;             // note of the diatonic scale of the key
+};
+
+///
+/// MIDIKeySpellingTable holds the spelling of all 128 midi notes in one key. The notes of the
+/// key get its letters and accidentals; the other notes get the letter with the fewest
+/// accidentals, sharps before flats in sharp keys and C, flats before sharps in flat keys.
+/// In minor keys the leading tone is spelled as the raised seventh degree (G# in A minor).
+///
+
+class MIDIKeySpellingTable
+{
+public:
+    MIDIKeySpellingTable()
+    {
+        Build ( 0, false );
+    }
+
+    MIDIKeySpellingTable ( int sharp_flats_, bool minor_ )
+    {
+        Build ( sharp_flats_, minor_ );
+    }
+
+    // sharp_flats_ as in the key signature meta event, -7 (7 flats) ... 7 (7 sharps)
+    void Build ( int sharp_flats_, bool minor_ );
+
+    const MIDINoteSpelling &GetSpelling ( int note ) const
+    {
+        return notes[note & 0x7f];
+    }
+
+    const MIDINoteSpelling &operator [] ( int note ) const
+    {
+        return notes[note & 0x7f];
+    }
+
+    int GetSharpFlats() const
+    {
+        return sharp_flats;
+    }
+
+    bool IsMinor() const
+    {
+        return minor;
+    }
+
+    // pitch class of the tonic, 0 = C
+    int GetTonic() const
+    {
+        return tonic;
+    }
+
+protected:
+    MIDINoteSpelling notes[128];
+    int sharp_flats;
+    bool minor;
+    int tonic;
+};
+
+///
+/// MIDIKeySignatureTimeline is the list of key signatures of a song, with a
+/// MIDIKeySpellingTable made once for each different key. The spelling of a note at a time is
+/// then a search for the key (or a step of a MIDIKeySignatureTimeline::Cursor while playing)
+/// and an array index. Before the first key signature the key is C major.
+///
+
+class MIDIKeySignatureTimeline
+{
+public:
+    struct Entry
+    {
+        MIDIClockTime clock;
+        int table;                  // number of the spelling table of the key
+    };
+
+    MIDIKeySignatureTimeline();
+    virtual ~MIDIKeySignatureTimeline();
+
+    void Clear();
+
+    // take the key signature events of all tracks of multitrack
+    void Build ( const MIDIMultiTrack *multitrack );
+
+    // add a key signature, for example from MIDIFileEvents::mf_keysig(). call Sort()
+    // if they are not added in time order
+    void Add ( MIDIClockTime clock, int sharp_flats, bool minor );
+
+    void Sort();
+
+    int GetNumEntries() const
+    {
+        return ( int ) entries.size();
+    }
+
+    const Entry &GetEntry ( int n ) const
+    {
+        return entries[n];
+    }
+
+    int GetNumTables() const
+    {
+        return ( int ) tables.size();
+    }
+
+    const MIDIKeySpellingTable &GetTable ( int table ) const
+    {
+        return tables[table];
+    }
+
+    // number of the spelling table of the key at clock
+    int GetTableNumAt ( MIDIClockTime clock ) const
+    {
+        return entries[FindEntryOfClock ( clock )].table;
+    }
+
+    const MIDIKeySpellingTable &GetTableAt ( MIDIClockTime clock ) const
+    {
+        return tables[GetTableNumAt ( clock )];
+    }
+
+    const MIDINoteSpelling &Spell ( MIDIClockTime clock, int note ) const
+    {
+        return GetTableAt ( clock ).GetSpelling ( note );
+    }
+
+    // give every event of track the number of the spelling table at its time, in one walk
+    void AssignTables ( const MIDITrack *track, std::vector<unsigned char> *event_tables ) const;
+
+    // number of last entry at or before clock
+    int FindEntryOfClock ( MIDIClockTime clock ) const;
+
+    ///
+    /// Cursor finds the key for increasing times with O(1) steps.
+    ///
+
+    class Cursor
+    {
+    public:
+        explicit Cursor ( const MIDIKeySignatureTimeline *timeline_ )
+            : timeline ( timeline_ ), entry ( 0 )
+        {
+        }
+
+        void Reset()
+        {
+            entry = 0;
+        }
+
+        int GetTableNumAt ( MIDIClockTime clock )
+        {
+            if ( clock < timeline->GetEntry ( entry ).clock )
+                entry = timeline->FindEntryOfClock ( clock );
+
+            while ( entry + 1 < timeline->GetNumEntries() && timeline->GetEntry ( entry + 1 ).clock <= clock )
+                ++entry;
+
+            return timeline->GetEntry ( entry ).table;
+        }
+
+        const MIDIKeySpellingTable &GetTableAt ( MIDIClockTime clock )
+        {
+            return timeline->GetTable ( GetTableNumAt ( clock ) );
+        }
+
+    protected:
+        const MIDIKeySignatureTimeline *timeline;
+        int entry;
+    };
+
+protected:
+    // number of the table of the key, made if there is none yet
+    int GetTableNum ( int sharp_flats, bool minor );
+
+    std::vector<Entry> entries;              // sorted by clock, never empty
+    std::vector<MIDIKeySpellingTable> tables;
+};
+
+}
+
+#endif
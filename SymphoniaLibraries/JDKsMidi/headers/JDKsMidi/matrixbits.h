@@ -0,0 +1,141 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_MATRIXBITS_H
+#define JDKSMIDI_MATRIXBITS_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/matrix.h"
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace jdksmidi
+{
+
+///
+/// MIDIMatrixBits is a MIDIMatrix which also keeps a 128 bit mask of the sounding notes of
+/// every channel. "Are any notes on" is answered from the masks without walking the note
+/// counts, ClearChannel() skips channels without notes, and the sounding notes are found
+/// with a count trailing zeros per note instead of testing all 128 counts.
+/// The Process() / GetNoteCount() interface is the one of MIDIMatrix.
+///
+
+class MIDIMatrixBits : public MIDIMatrix
+{
+public:
+    MIDIMatrixBits();
+    virtual ~MIDIMatrixBits();
+
+    virtual void Clear();
+
+    bool IsNoteOn ( int channel, int note ) const
+    {
+        return ( note_mask[channel][note >> 6] >> ( note & 63 ) & 1 ) != 0;
+    }
+
+    bool AnyNotesOn ( int channel ) const
+    {
+        return ( note_mask[channel][0] | note_mask[channel][1] ) != 0;
+    }
+
+    bool AnyNotesOn() const;
+
+    // number of different notes on in channel
+    int GetNumNotesOn ( int channel ) const
+    {
+        return PopCount ( note_mask[channel][0] ) + PopCount ( note_mask[channel][1] );
+    }
+
+    // bit n of mask[0] is note n, bit n of mask[1] is note 64+n
+    void GetNoteMask ( int channel, uint64_t mask[2] ) const
+    {
+        mask[0] = note_mask[channel][0];
+        mask[1] = note_mask[channel][1];
+    }
+
+    // first note on at or above note, -1 if there is none
+    int GetNextNoteOn ( int channel, int note ) const;
+
+    // store the notes on in channel in notes (up to 128), return number of notes
+    int GetNotesOn ( int channel, unsigned char *notes ) const;
+
+    // bit n is set if channel n has notes on
+    unsigned int GetActiveChannels() const;
+
+    static int PopCount ( uint64_t v )
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return ( int ) __popcnt64 ( v );
+#elif defined(__GNUC__)
+        return __builtin_popcountll ( v );
+#else
+        int n = 0;
+
+        for ( ; v != 0; v &= v - 1 )
+            ++n;
+
+        return n;
+#endif
+    }
+
+    // index of the lowest set bit, v must not be 0
+    static int CountTrailingZeros ( uint64_t v )
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64 ( &index, v );
+        return ( int ) index;
+#elif defined(__GNUC__)
+        return __builtin_ctzll ( v );
+#else
+        int n = 0;
+
+        for ( ; ( v & 1 ) == 0; v >>= 1 )
+            ++n;
+
+        return n;
+#endif
+    }
+
+protected:
+    virtual void DecNoteCount ( const MIDIMessage &m, int channel, int note );
+    virtual void IncNoteCount ( const MIDIMessage &m, int channel, int note );
+    virtual void ClearChannel ( int channel );
+
+    void UpdateNoteBit ( int channel, int note )
+    {
+        uint64_t bit = ( uint64_t ) 1 << ( note & 63 );
+
+        if ( GetNoteCount ( channel, note ) > 0 )
+            note_mask[channel][note >> 6] |= bit;
+        else
+            note_mask[channel][note >> 6] &= ~bit;
+    }
+
+    uint64_t note_mask[16][2];
+};
+
+}
+
+#endif
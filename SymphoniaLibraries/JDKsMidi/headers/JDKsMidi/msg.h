@@ -42,6 +42,8 @@
 #include "jdksmidi/tempo.h"
 #include "jdksmidi/sysex.h"
 
+#include <utility>
+
 namespace jdksmidi
 {
 
@@ -596,6 +598,26 @@ public:
 
     const MIDIBigMessage &operator = ( const MIDIMessage &m );
 
+    /// Move constructor and assignment take over the sysex of m instead of copying it, m is left without sysex.
+    MIDIBigMessage ( MIDIBigMessage &&m ) noexcept
+        : MIDIMessage ( m ), sysex ( m.sysex )
+    {
+        m.sysex = 0;
+    }
+
+    const MIDIBigMessage &operator = ( MIDIBigMessage &&m ) noexcept
+    {
+        if ( this != &m )
+        {
+            MIDIMessage::Copy ( m );
+            ClearSysEx();
+            sysex = m.sysex;
+            m.sysex = 0;
+        }
+
+        return *this;
+    }
+
 
     void Copy ( const MIDIBigMessage &m );
 
@@ -769,6 +791,11 @@ public:
 
     MIDITimedBigMessage ( const MIDITimedMessage &m, const MIDISystemExclusive *e );
 
+    MIDITimedBigMessage ( MIDITimedBigMessage &&m ) noexcept
+        : MIDIBigMessage ( std::move ( m ) ), time ( m.time )
+    {
+    }
+
     void Clear();
 
     void Copy ( const MIDITimedBigMessage &m );
@@ -781,6 +808,13 @@ public:
 
     const MIDITimedBigMessage &operator = ( const MIDITimedBigMessage & m );
 
+    const MIDITimedBigMessage &operator = ( MIDITimedBigMessage && m ) noexcept
+    {
+        MIDIBigMessage::operator = ( std::move ( m ) );
+        time = m.time;
+        return *this;
+    }
+
     const MIDITimedBigMessage &operator = ( const MIDITimedMessage & m );
 
     const MIDITimedBigMessage &operator = ( const MIDIMessage & m );
@@ -831,6 +865,11 @@ public:
 
     MIDIDeltaTimedBigMessage ( const MIDIDeltaTimedMessage &m );
 
+    MIDIDeltaTimedBigMessage ( MIDIDeltaTimedBigMessage &&m ) noexcept
+        : MIDIBigMessage ( std::move ( m ) ), dtime ( m.dtime )
+    {
+    }
+
     void Clear();
 
     void Copy ( const MIDIDeltaTimedBigMessage &m );
@@ -843,6 +882,13 @@ public:
 
     const MIDIDeltaTimedBigMessage &operator = ( const MIDIDeltaTimedBigMessage &m );
 
+    const MIDIDeltaTimedBigMessage &operator = ( MIDIDeltaTimedBigMessage &&m ) noexcept
+    {
+        MIDIBigMessage::operator = ( std::move ( m ) );
+        dtime = m.dtime;
+        return *this;
+    }
+
     const MIDIDeltaTimedBigMessage &operator = ( const MIDIDeltaTimedMessage &m );
 
     const MIDIDeltaTimedBigMessage &operator = ( const MIDIMessage &m );
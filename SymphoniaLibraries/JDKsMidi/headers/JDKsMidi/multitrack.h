@@ -99,6 +99,17 @@ public:
         return AssignEventsToTracks( GetTrack( track_num ) );
     }
 
+    // the same as AssignEventsToTracks(), in two passes over blocks of the src events: count
+    // the events of every track, then copy each event to its place in the presized tracks.
+    // the blocks are done by num_threads threads (0 = one per cpu), the event order is kept.
+    // a src track of this multitrack is taken over without copy
+    bool AssignEventsToTracksParallel ( const MIDITrack *src, int num_threads = 0 );
+
+    bool AssignEventsToTracksParallel ( int track_num = 0, int num_threads = 0 )
+    {
+        return AssignEventsToTracksParallel( GetTrack( track_num ), num_threads );
+    }
+
     void Clear();
 
     int GetClksPerBeat() const
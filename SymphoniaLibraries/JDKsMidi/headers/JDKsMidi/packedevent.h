@@ -0,0 +1,249 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_PACKEDEVENT_H
+#define JDKSMIDI_PACKEDEVENT_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/sysex.h"
+#include "jdksmidi/track.h"
+#include "jdksmidi/sysexpool.h"
+
+#include <stdint.h>
+
+namespace jdksmidi
+{
+
+class MIDIPackedEvent;
+class MIDIPackedPayloadPool;
+class MIDIPackedTrack;
+
+///
+/// MIDIPackedEvent is an 8 byte event for the common case of a channel message with a time.
+/// Every other event (meta, sysex, service and system messages) keeps only its status here;
+/// the rest is stored in a MIDIPackedPayloadPool and the event holds a 23 bit index into it:
+/// d1 is the low, d2 the middle and the low 7 bits of flags the high byte of the index.
+///
+
+class MIDIPackedEvent
+{
+public:
+    enum
+    {
+        PAYLOAD_FLAG = 0x80, // flags bit: event data is in the payload pool
+        MAX_PAYLOAD_INDEX = 0x7fffff
+    };
+
+    MIDIPackedEvent()
+        : time ( 0 ), status ( 0 ), d1 ( 0 ), d2 ( 0 ), flags ( 0 )
+    {
+    }
+
+    MIDIPackedEvent ( MIDIClockTime t, unsigned char status_, unsigned char d1_, unsigned char d2_ )
+        : time ( ( uint32_t ) t ), status ( status_ ), d1 ( d1_ ), d2 ( d2_ ), flags ( 0 )
+    {
+    }
+
+    MIDIClockTime GetTime() const
+    {
+        return time;
+    }
+
+    void SetTime ( MIDIClockTime t )
+    {
+        time = ( uint32_t ) t;
+    }
+
+    unsigned char GetStatus() const
+    {
+        return status;
+    }
+
+    unsigned char GetByte1() const
+    {
+        return d1;
+    }
+
+    unsigned char GetByte2() const
+    {
+        return d2;
+    }
+
+    bool HasPayload() const
+    {
+        return ( flags & PAYLOAD_FLAG ) != 0;
+    }
+
+    unsigned long GetPayloadIndex() const
+    {
+        return ( unsigned long ) d1 | ( ( unsigned long ) d2 << 8 ) | ( ( unsigned long ) ( flags & 0x7f ) << 16 );
+    }
+
+    void SetPayloadIndex ( unsigned long index )
+    {
+        d1 = ( uint8_t ) ( index & 0xff );
+        d2 = ( uint8_t ) ( ( index >> 8 ) & 0xff );
+        flags = ( uint8_t ) ( PAYLOAD_FLAG | ( ( index >> 16 ) & 0x7f ) );
+    }
+
+    bool IsChannelMsg() const
+    {
+        return !HasPayload() && status >= 0x80 && status < 0xf0;
+    }
+
+    unsigned char GetType() const
+    {
+        return ( unsigned char ) ( status & 0xf0 );
+    }
+
+    unsigned char GetChannel() const
+    {
+        return ( unsigned char ) ( status & 0x0f );
+    }
+
+    bool IsNoteOn() const
+    {
+        return IsChannelMsg() && GetType() == NOTE_ON;
+    }
+
+    bool IsNoteOff() const
+    {
+        return IsChannelMsg() && GetType() == NOTE_OFF;
+    }
+
+    uint32_t time;
+    uint8_t status;
+    uint8_t d1;
+    uint8_t d2;
+    uint8_t flags;
+};
+
+///
+/// MIDIPackedPayloadPool holds the data of all events which do not fit into a MIDIPackedEvent.
+/// One pool can be shared by many MIDIPackedTrack objects. Sysex and long meta event data is
+/// interned in a MIDISysExPool instead of a MIDISystemExclusive allocation per event.
+///
+
+class MIDIPackedPayloadPool
+{
+public:
+    MIDIPackedPayloadPool();
+    virtual ~MIDIPackedPayloadPool();
+
+    void Clear();
+
+    // store all of msg except the time, return the payload index or -1 if the pool is full
+    long Add ( const MIDIBigMessage &msg );
+
+    // fill msg with the stored payload, without time
+    void Get ( unsigned long index, MIDIBigMessage *msg ) const;
+
+    // the message part (status, byte1...byte6, data_length, service_num) of the payload
+    const MIDIMessage &GetMessage ( unsigned long index ) const
+    {
+        return payloads[index].msg;
+    }
+
+    // the sysex data of the payload, 0 if it has no sysex
+    const unsigned char *GetSysExData ( unsigned long index, int *len ) const;
+
+    unsigned long GetNumPayloads() const
+    {
+        return ( unsigned long ) payloads.size();
+    }
+
+    const MIDISysExPool &GetSysExPool() const
+    {
+        return sysex_pool;
+    }
+
+protected:
+    struct Payload
+    {
+        MIDIMessage msg;
+        long sysex_blob; // MIDISysExPool::NO_BLOB if the message has no sysex
+    };
+
+    std::vector<Payload> payloads;
+    MIDISysExPool sysex_pool;
+};
+
+///
+/// MIDIPackedTrack is a track of MIDIPackedEvent with its payloads in a shared pool. It converts
+/// from and to MIDITimedBigMessage and MIDITrack, so existing code can keep using those.
+///
+
+class MIDIPackedTrack
+{
+public:
+    explicit MIDIPackedTrack ( MIDIPackedPayloadPool *pool_ );
+    virtual ~MIDIPackedTrack();
+
+    void Clear()
+    {
+        events.clear();
+    }
+
+    int GetNumEvents() const
+    {
+        return ( int ) events.size();
+    }
+
+    const MIDIPackedEvent *GetEventAddress ( int event_num ) const
+    {
+        return &events[event_num];
+    }
+
+    MIDIPackedEvent *GetEventAddress ( int event_num )
+    {
+        return &events[event_num];
+    }
+
+    // keep only the first num_events events
+    void Resize ( int num_events )
+    {
+        events.resize ( num_events );
+    }
+
+    const MIDIPackedPayloadPool *GetPool() const
+    {
+        return pool;
+    }
+
+    // return false if the payload pool is full
+    bool PutEvent ( const MIDITimedBigMessage &msg );
+
+    // convert event event_num back to a MIDITimedBigMessage
+    void GetEvent ( int event_num, MIDITimedBigMessage *msg ) const;
+
+    // replace all events with the events of track, return false if the payload pool is full
+    bool FromTrack ( const MIDITrack *track );
+
+    // append all events to track, return false if the track is full
+    bool ToTrack ( MIDITrack *track ) const;
+
+protected:
+    MIDIPackedPayloadPool *pool;
+    std::vector<MIDIPackedEvent> events;
+};
+
+}
+
+#endif
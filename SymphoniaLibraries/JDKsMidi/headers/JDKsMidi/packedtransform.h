@@ -0,0 +1,119 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_PACKEDTRANSFORM_H
+#define JDKSMIDI_PACKEDTRANSFORM_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/packedevent.h"
+
+namespace jdksmidi
+{
+
+class MIDIPackedTransform;
+class MIDIProcessorTransposer;
+class MIDIProcessorRechannelizer;
+class MIDISequencerTrackProcessor;
+
+///
+/// MIDIPackedTransform transposes, scales the velocity of and rechannelizes many events at
+/// once, for offline work on whole songs where MIDIProcessorTransposer,
+/// MIDIProcessorRechannelizer and MIDISequencerTrackProcessor would be called for every
+/// MIDITimedBigMessage. The events are given as separate status, byte1 and byte2 arrays; the
+/// kernel works on 16 events per step with SSE2 where the compiler targets it, and one event
+/// at a time otherwise. Only channel messages are changed, the test is done in the kernel.
+///
+/// All settings are per source channel (the channel before the rechannelization). Note on,
+/// note off and poly pressure notes are transposed; note on velocities (not 0) are scaled by
+/// percent and clamped to 1...127. Transposed notes are clamped to 0...127, or dropped as
+/// the per-message processors do if SetDropOutOfRange() is on. A dropped event gets status 0.
+///
+
+class MIDIPackedTransform
+{
+public:
+    MIDIPackedTransform();
+    virtual ~MIDIPackedTransform();
+
+    // no transposition, velocity scale 100, every channel to itself, clamping
+    void Clear();
+
+    // trans is clamped to -127...127
+    void SetTranspose ( int chan, int trans );
+    void SetAllTranspose ( int trans );
+
+    int GetTranspose ( int chan ) const
+    {
+        return transpose[chan];
+    }
+
+    // percent is clamped to 0...65535, 100 is normal
+    void SetVelocityScale ( int chan, int percent );
+    void SetAllVelocityScale ( int percent );
+
+    int GetVelocityScale ( int chan ) const
+    {
+        return velocity_scale[chan];
+    }
+
+    // dest_chan -1 drops the channel messages of src_chan, as in MIDIProcessorRechannelizer
+    void SetRechannel ( int src_chan, int dest_chan );
+    void SetAllRechannel ( int dest_chan );
+
+    int GetRechannel ( int src_chan ) const
+    {
+        return rechannel[src_chan];
+    }
+
+    void SetDropOutOfRange ( bool f )
+    {
+        drop_out_of_range = f;
+    }
+
+    bool GetDropOutOfRange() const
+    {
+        return drop_out_of_range;
+    }
+
+    // take the settings of a processor. the transposer and the track processor drop notes out
+    // of range, so these turn SetDropOutOfRange() on. mute and solo of the track processor
+    // are not part of the transform
+    void SetFromTransposer ( const MIDIProcessorTransposer &proc );
+    void SetFromRechannelizer ( const MIDIProcessorRechannelizer &proc );
+    void SetFromTrackProcessor ( const MIDISequencerTrackProcessor &proc );
+
+    // transform num events in place, return the number of dropped events
+    int Apply ( unsigned char *status, unsigned char *byte1, unsigned char *byte2, int num ) const;
+
+    // the same without SSE2
+    int ApplyScalar ( unsigned char *status, unsigned char *byte1, unsigned char *byte2, int num ) const;
+
+    // transform all events of track and remove the dropped ones, return the number of dropped events
+    int Apply ( MIDIPackedTrack *track ) const;
+
+protected:
+    signed char transpose[16];
+    unsigned short velocity_scale[16];
+    signed char rechannel[16];
+    bool drop_out_of_range;
+};
+
+}
+
+#endif
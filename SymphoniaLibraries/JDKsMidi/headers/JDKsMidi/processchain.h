@@ -0,0 +1,279 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_PROCESSCHAIN_H
+#define JDKSMIDI_PROCESSCHAIN_H
+
+#include "jdksmidi/msg.h"
+#include "jdksmidi/process.h"
+
+#include <tuple>
+
+namespace jdksmidi
+{
+
+///
+/// Processor stages for MIDIProcessorChain. A stage is any class with a non virtual
+/// bool Process ( MIDITimedBigMessage *msg ), returning false if the message is to be dropped.
+/// The stages below do the work of MIDIProcessorTransposer, MIDIProcessorRechannelizer and
+/// the velocity scale of MIDISequencerTrackProcessor, but everything is inline.
+///
+
+class MIDIStageTransposer
+{
+public:
+    MIDIStageTransposer()
+    {
+        SetAllTranspose ( 0 );
+    }
+
+    void SetTransposeChannel ( int chan, int trans )
+    {
+        trans_amount[chan] = trans;
+    }
+
+    int GetTransposeChannel ( int chan ) const
+    {
+        return trans_amount[chan];
+    }
+
+    void SetAllTranspose ( int trans )
+    {
+        for ( int chan = 0; chan < 16; ++chan )
+            trans_amount[chan] = trans;
+    }
+
+    // transpose note on, note off and poly pressure, drop notes out of range
+    bool Process ( MIDITimedBigMessage *msg )
+    {
+        unsigned char type = ( unsigned char ) ( msg->GetStatus() & 0xf0 );
+
+        if ( msg->IsServiceMsg() || ( type != NOTE_ON && type != NOTE_OFF && type != POLY_PRESSURE ) )
+            return true;
+
+        int new_note = msg->GetNote() + trans_amount[msg->GetStatus() & 0x0f];
+
+        if ( new_note < 0 || new_note > 127 )
+            return false;
+
+        msg->SetNote ( ( unsigned char ) new_note );
+        return true;
+    }
+
+private:
+    int trans_amount[16];
+};
+
+class MIDIStageRechannelizer
+{
+public:
+    MIDIStageRechannelizer()
+    {
+        for ( int chan = 0; chan < 16; ++chan )
+            rechan_map[chan] = chan;
+    }
+
+    // dest_chan -1 drops the messages of src_chan
+    void SetRechanMap ( int src_chan, int dest_chan )
+    {
+        rechan_map[src_chan] = dest_chan;
+    }
+
+    int GetRechanMap ( int src_chan ) const
+    {
+        return rechan_map[src_chan];
+    }
+
+    void SetAllRechan ( int dest_chan )
+    {
+        for ( int chan = 0; chan < 16; ++chan )
+            rechan_map[chan] = dest_chan;
+    }
+
+    bool Process ( MIDITimedBigMessage *msg )
+    {
+        unsigned char status = msg->GetStatus();
+
+        if ( msg->IsServiceMsg() || status < 0x80 || status >= 0xf0 )
+            return true;
+
+        int new_chan = rechan_map[status & 0x0f];
+
+        if ( new_chan < 0 )
+            return false;
+
+        msg->SetStatus ( ( unsigned char ) ( ( status & 0xf0 ) | ( new_chan & 0x0f ) ) );
+        return true;
+    }
+
+private:
+    int rechan_map[16];
+};
+
+class MIDIStageVelocityScale
+{
+public:
+    MIDIStageVelocityScale()
+        : velocity_scale ( 100 )
+    {
+    }
+
+    // velocity scale in percent for note ons, 100=normal
+    void SetVelocityScale ( int scale )
+    {
+        velocity_scale = scale;
+    }
+
+    int GetVelocityScale() const
+    {
+        return velocity_scale;
+    }
+
+    bool Process ( MIDITimedBigMessage *msg )
+    {
+        if ( velocity_scale == 100 || msg->IsServiceMsg() || ( msg->GetStatus() & 0xf0 ) != NOTE_ON )
+            return true;
+
+        int vel = msg->GetVelocity();
+
+        // velocity 0 is note off and stays so
+        if ( vel == 0 )
+            return true;
+
+        vel = vel * velocity_scale / 100;
+
+        if ( vel < 1 )
+            vel = 1;
+        else if ( vel > 127 )
+            vel = 127;
+
+        msg->SetVelocity ( ( unsigned char ) vel );
+        return true;
+    }
+
+private:
+    int velocity_scale;
+};
+
+///
+/// MIDIStageProcessor lets a virtual MIDIProcessor (for example a track extra_proc) be one stage
+/// of a MIDIProcessorChain. A 0 processor lets all messages through.
+///
+
+class MIDIStageProcessor
+{
+public:
+    MIDIStageProcessor()
+        : proc ( 0 )
+    {
+    }
+
+    void SetProcessor ( MIDIProcessor *proc_ )
+    {
+        proc = proc_;
+    }
+
+    MIDIProcessor *GetProcessor() const
+    {
+        return proc;
+    }
+
+    bool Process ( MIDITimedBigMessage *msg )
+    {
+        return proc == 0 || proc->Process ( msg );
+    }
+
+private:
+    MIDIProcessor *proc;
+};
+
+///
+/// MIDIProcessorChain runs its stages in the order of the template arguments, for example
+/// MIDIProcessorChain<MIDIStageTransposer, MIDIStageRechannelizer, MIDIStageVelocityScale>.
+/// The stages are known at compile time, so the whole chain is one inline function instead of
+/// a virtual call per stage like MIDIMultiProcessor. The chain itself is a MIDIProcessor and
+/// can be used where one is expected.
+///
+
+template <typename... Stages>
+class MIDIProcessorChain : public MIDIProcessor
+{
+public:
+    MIDIProcessorChain()
+    {
+    }
+
+    virtual ~MIDIProcessorChain()
+    {
+    }
+
+    // stage number n of the chain
+    template <int n>
+    typename std::tuple_element<n, std::tuple<Stages...> >::type &GetStage()
+    {
+        return std::get<n> ( stages );
+    }
+
+    template <int n>
+    const typename std::tuple_element<n, std::tuple<Stages...> >::type &GetStage() const
+    {
+        return std::get<n> ( stages );
+    }
+
+    // return false if a stage dropped the message; the later stages do not see it
+    virtual bool Process ( MIDITimedBigMessage *msg )
+    {
+        return ProcessStages ( msg, std::integral_constant<int, 0>() );
+    }
+
+    // process num_msgs messages with one call, messages which are dropped are made NoOp.
+    // return number of messages which are left
+    int Process ( MIDITimedBigMessage *msgs, int num_msgs )
+    {
+        int num_left = 0;
+
+        for ( int i = 0; i < num_msgs; ++i )
+        {
+            if ( ProcessStages ( &msgs[i], std::integral_constant<int, 0>() ) )
+                ++num_left;
+            else
+                msgs[i].SetNoOp();
+        }
+
+        return num_left;
+    }
+
+private:
+    bool ProcessStages ( MIDITimedBigMessage *, std::integral_constant<int, sizeof... ( Stages ) > )
+    {
+        return true;
+    }
+
+    template <int n>
+    bool ProcessStages ( MIDITimedBigMessage *msg, std::integral_constant<int, n> )
+    {
+        return std::get<n> ( stages ).Process ( msg ) && ProcessStages ( msg, std::integral_constant < int, n + 1 > () );
+    }
+
+    std::tuple<Stages...> stages;
+};
+
+}
+
+#endif
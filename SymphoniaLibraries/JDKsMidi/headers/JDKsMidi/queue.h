@@ -55,6 +55,12 @@ public:
         next_in = ( next_in + 1 ) % bufsize;
     }
 
+    void Put ( MIDITimedBigMessage &&msg )
+    {
+        buf[next_in] = std::move ( msg );
+        next_in = ( next_in + 1 ) % bufsize;
+    }
+
     MIDITimedBigMessage Get() const
     {
         return MIDITimedBigMessage ( buf[next_out] );
@@ -42,6 +42,7 @@ class MIDISequencerGUIEvent;
 class MIDISequencerGUIEventNotifier;
 class MIDISequencerTrackState;
 class MIDISequencer;
+class MIDITempoMap;
 
 class MIDISequencerGUIEvent
 {
@@ -320,6 +321,9 @@ public:
     bool GoToTimeMs ( float time_ms );
     bool GoToMeasure ( int measure, int beat = 0 );
 
+    // go to time_ms with the tempo map of the song instead of playing up to the time
+    bool GoToTimeMs ( double time_ms, const MIDITempoMap &tempo_map );
+
     bool GetNextEventTimeMs ( float *t );
     bool GetNextEventTimeMs ( double *t );
     bool GetNextEventTime ( MIDIClockTime *t );
@@ -331,6 +335,9 @@ public:
 	double GetMusicDurationInMilliseconds();
     double GetMisicDurationInSeconds();
 
+    // the same as GetMusicDurationInMilliseconds() from the tempo map of the song, without playing it
+    double GetMusicDurationInMilliseconds ( const MIDITempoMap &tempo_map ) const;
+
 protected:
 
     MIDITimedBigMessage beat_marker_msg;
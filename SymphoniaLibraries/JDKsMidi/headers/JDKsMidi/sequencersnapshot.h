@@ -0,0 +1,170 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_SEQUENCERSNAPSHOT_H
+#define JDKSMIDI_SEQUENCERSNAPSHOT_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/matrix.h"
+#include "jdksmidi/sequencer.h"
+
+#include <stdint.h>
+#include <unordered_map>
+
+namespace jdksmidi
+{
+
+class MIDISequencerSnapshotNames;
+class MIDISequencerSnapshot;
+
+///
+/// MIDISequencerSnapshotNames keeps every different track name once, snapshots only store
+/// the name number. One object is shared by all snapshots of a song.
+///
+
+class MIDISequencerSnapshotNames
+{
+public:
+    MIDISequencerSnapshotNames();
+    virtual ~MIDISequencerSnapshotNames();
+
+    void Clear();
+
+    // return the number of name, added if it is not known yet
+    int Intern ( const char *name );
+
+    const char *GetName ( int name_num ) const
+    {
+        return names[name_num].c_str();
+    }
+
+    int GetNumNames() const
+    {
+        return ( int ) names.size();
+    }
+
+protected:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> name_nums;
+};
+
+///
+/// MIDISequencerSnapshot is a compact copy of a MIDISequencerState. Unlike the state it only
+/// holds the tracks in use, the track names as numbers in a MIDISequencerSnapshotNames, and
+/// the note matrix of each track as bitsets of the sounding notes, so a snapshot of a song
+/// with few notes on costs a few hundred bytes instead of a full MIDISequencerState copy.
+///
+
+class MIDISequencerSnapshot
+{
+public:
+    MIDISequencerSnapshot();
+    virtual ~MIDISequencerSnapshot();
+
+    void Clear();
+
+    void Capture ( const MIDISequencerState &state, MIDISequencerSnapshotNames *names );
+
+    void Capture ( const MIDISequencer &seq, MIDISequencerSnapshotNames *names )
+    {
+        Capture ( *seq.GetState(), names );
+    }
+
+    // restore the state of the snapshot. the state must be of the same song,
+    // tracks of the snapshot which are not in the state are ignored
+    void Restore ( MIDISequencerState *state, const MIDISequencerSnapshotNames &names ) const;
+
+    void Restore ( MIDISequencer *seq, const MIDISequencerSnapshotNames &names ) const
+    {
+        Restore ( seq->GetState(), names );
+    }
+
+    int GetNumTracks() const
+    {
+        return ( int ) tracks.size();
+    }
+
+    MIDIClockTime GetCurrentMIDIClockTime() const
+    {
+        return cur_clock;
+    }
+
+    float GetCurrentTimeInMs() const
+    {
+        return cur_time_ms;
+    }
+
+    int GetCurrentBeat() const
+    {
+        return cur_beat;
+    }
+
+    int GetCurrentMeasure() const
+    {
+        return cur_measure;
+    }
+
+protected:
+    struct TrackSnapshot
+    {
+        float tempobpm;
+        int pg;
+        int volume;
+        int timesig_numerator;
+        int timesig_denominator;
+        int bender_value;
+        int name_num;
+        bool got_good_track_name;
+        bool notes_are_on;
+
+        int next_event_number;
+        MIDIClockTime next_event_time;
+
+        uint16_t active_channels;  // bit n is set if channel n has notes on
+        uint16_t hold_pedals;      // bit n is set if channel n hold pedal is down
+        unsigned long first_mask;  // index in note_masks of the first active channel
+        unsigned long first_count; // index in note_counts of the first note on more than once
+        unsigned long num_counts;
+    };
+
+    // a note which is on more than once
+    struct NoteCount
+    {
+        unsigned char channel;
+        unsigned char note;
+        unsigned char count;
+    };
+
+    std::vector<TrackSnapshot> tracks;
+    std::vector<uint64_t> note_masks; // two words (notes 0-63, 64-127) for every active channel
+    std::vector<NoteCount> note_counts;
+
+    MIDIClockTime iterator_cur_time;
+    int iterator_cur_event_track;
+
+    MIDIClockTime cur_clock;
+    float cur_time_ms;
+    int cur_beat;
+    int cur_measure;
+    MIDIClockTime next_beat_time;
+};
+
+}
+
+#endif
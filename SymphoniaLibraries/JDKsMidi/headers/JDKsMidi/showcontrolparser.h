@@ -0,0 +1,185 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_SHOWCONTROLPARSER_H
+#define JDKSMIDI_SHOWCONTROLPARSER_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/showcontrol.h"
+#include "jdksmidi/showcontrolhandler.h"
+
+namespace jdksmidi
+{
+
+struct MIDIShowControlCue;
+struct MIDIShowControlCommand;
+class MIDIShowControlParser;
+class MIDIShowControlDispatcher;
+
+///
+/// MIDIShowControlCue is a cue number, list or path like "235.6.5" as up to three values.
+///
+
+struct MIDIShowControlCue
+{
+    ulong value[3];
+    int num_values;     // 0 if the cue was not given
+
+    MIDICue ToCue() const
+    {
+        MIDICue cue ( value[0], value[1], value[2] );
+        cue.SetNumValues ( num_values > 0 ? num_values : 1 );
+        return cue;
+    }
+};
+
+///
+/// MIDIShowControlCommand is one decoded MIDI Show Control message, a plain struct which can
+/// be copied and kept without any allocation. The fields which a command does not have stay 0.
+///
+
+struct MIDIShowControlCommand
+{
+    enum
+    {
+        HAS_TIME = 0x01,
+        HAS_Q_NUMBER = 0x02,
+        HAS_Q_LIST = 0x04,
+        HAS_Q_PATH = 0x08
+    };
+
+    uchar device_id;
+    uchar command_format;
+    uchar command;      // MIDIShowCommand
+    uchar flags;
+
+    // time of timed go, set and set clock, as in the message (hours with the rate bits)
+    uchar hours;
+    uchar minutes;
+    uchar seconds;
+    uchar frames;
+    uchar fract_frames;
+
+    MIDIShowControlCue q_number;
+    MIDIShowControlCue q_list;
+    MIDIShowControlCue q_path;
+
+    ulong val1;     // macro number of fire, control number of set
+    ulong val2;     // control value of set
+
+    bool HasTime() const
+    {
+        return ( flags & HAS_TIME ) != 0;
+    }
+
+    bool HasQNumber() const
+    {
+        return ( flags & HAS_Q_NUMBER ) != 0;
+    }
+
+    bool HasQList() const
+    {
+        return ( flags & HAS_Q_LIST ) != 0;
+    }
+
+    bool HasQPath() const
+    {
+        return ( flags & HAS_Q_PATH ) != 0;
+    }
+};
+
+///
+/// MIDIShowControlParser decodes a MIDI Show Control message straight from its bytes, without
+/// copying them into a MIDIShowControlPacket and MIDISystemExclusive first. The bytes may start
+/// with 0xf0 and end with 0xf7, or be the sysex data without them as in a MIDISystemExclusive.
+///
+
+class MIDIShowControlParser
+{
+public:
+    // return false if data is not a valid show control message
+    static bool Parse ( const uchar *data, int len, MIDIShowControlCommand *cmd );
+
+    static bool Parse ( const MIDISystemExclusive &sysex, MIDIShowControlCommand *cmd )
+    {
+        return Parse ( sysex.GetBuf(), sysex.GetLengthSE(), cmd );
+    }
+
+    // true if data starts like a show control message (universal real time, sub id 2)
+    static bool IsShowControl ( const uchar *data, int len );
+
+protected:
+    static bool ParseCues ( const uchar **p, const uchar *end, MIDIShowControlCommand *cmd, int first_cue );
+    static bool ParseCue ( const uchar **p, const uchar *end, MIDIShowControlCue *cue );
+    static bool ParseTime ( const uchar **p, const uchar *end, MIDIShowControlCommand *cmd );
+};
+
+///
+/// MIDIShowControlDispatcher calls the MIDISCHandle method of a show control message through
+/// a table with one function per command byte, instead of a switch over the command and
+/// the cues given. Nothing is allocated, so it can be called from the sequencer thread for
+/// every sysex event of a show file. The functions can be replaced per command.
+///
+
+class MIDIShowControlDispatcher
+{
+public:
+    typedef bool ( *CommandFunction ) ( MIDISCHandle *handle, const MIDIShowControlCommand &cmd );
+
+    // only messages to device_id, to the all call id 0x7f or, with device_id 0x7f, to any
+    // device are dispatched
+    explicit MIDIShowControlDispatcher ( MIDISCHandle *handle_, uchar device_id_ = 0x7f );
+    virtual ~MIDIShowControlDispatcher();
+
+    void SetHandle ( MIDISCHandle *h )
+    {
+        handle = h;
+    }
+
+    void SetDeviceId ( uchar id )
+    {
+        device_id = id;
+    }
+
+    // f 0 ignores the command
+    void SetCommandFunction ( uchar command, CommandFunction f )
+    {
+        table[command & 0x7f] = f;
+    }
+
+    CommandFunction GetCommandFunction ( uchar command ) const
+    {
+        return table[command & 0x7f];
+    }
+
+    // return the result of the handle, false if the message is not dispatched
+    bool Dispatch ( const MIDIShowControlCommand &cmd ) const;
+    bool Dispatch ( const uchar *data, int len ) const;
+    bool Dispatch ( const MIDIBigMessage &msg ) const;
+
+protected:
+    MIDISCHandle *handle;
+    uchar device_id;
+    CommandFunction table[128];
+};
+
+}
+
+#endif
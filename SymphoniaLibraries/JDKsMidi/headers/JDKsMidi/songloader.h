@@ -0,0 +1,182 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_SONGLOADER_H
+#define JDKSMIDI_SONGLOADER_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/multitrack.h"
+#include "jdksmidi/tempomap.h"
+#include "jdksmidi/sequencersnapshot.h"
+#include "jdksmidi/advancedsequencer.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDISongLoader;
+
+///
+/// MIDISongLoader does the work of AdvancedSequencer::Load() on a thread of its own, so the
+/// caller does not block while a song is read, decoded and indexed. The load goes through
+/// the stages read (the file into memory), decode (the MTrk chunks, several tracks at once
+/// on num_threads threads), tempo map and warp index (the sequencer states every
+/// MEASURES_PER_WARP measures, kept as MIDISequencerSnapshot). The tempo map and the markers
+/// do not depend on the warp index and are built on another thread at the same time, so
+/// GetStage() reports both as STAGE_INDEX and GetStageProgress() tells them apart.
+///
+/// The progress of every stage can be polled from any thread. Cancel() (or a new Start(),
+/// when the user picks another song) stops the load at the next chunk or measure. When the
+/// load is ready, Commit() installs the song into an AdvancedSequencer; this must be called
+/// from the thread which owns the sequencer.
+///
+
+class MIDISongLoader
+{
+public:
+    enum Stage
+    {
+        STAGE_IDLE,
+        STAGE_READ,
+        STAGE_DECODE,
+        STAGE_TEMPO_MAP,    // only for GetStageProgress(), built during STAGE_INDEX
+        STAGE_WARP_INDEX,   // only for GetStageProgress(), built during STAGE_INDEX
+        STAGE_INDEX,        // tempo map and warp index at the same time
+        STAGE_READY,
+        STAGE_FAILED,
+        STAGE_CANCELLED
+    };
+
+    // num_threads 0 decodes on as many threads as the hardware has
+    explicit MIDISongLoader ( int num_threads_ = 0 );
+    virtual ~MIDISongLoader();
+
+    // start loading fname, a load which is still running is cancelled first
+    void Start ( const char *fname );
+
+    // stop the load and wait for its thread
+    void Cancel();
+
+    // wait until the load is done, return true if it is ready
+    bool Wait();
+
+    Stage GetStage() const
+    {
+        return ( Stage ) stage.load();
+    }
+
+    bool IsBusy() const
+    {
+        return stage >= STAGE_READ && stage <= STAGE_INDEX;
+    }
+
+    bool IsReady() const
+    {
+        return stage == STAGE_READY;
+    }
+
+    // progress of stage s from STAGE_READ to STAGE_WARP_INDEX, 0...1
+    float GetStageProgress ( Stage s ) const
+    {
+        return ( s >= STAGE_READ && s <= STAGE_WARP_INDEX ) ? progress[s - STAGE_READ].load() : 0.0f;
+    }
+
+    // progress of the whole load, 0...1
+    float GetProgress() const;
+
+    const std::string &GetFileName() const
+    {
+        return file_name;
+    }
+
+    // the results, only while the load is ready
+    const MIDIMultiTrack &GetMultiTrack() const
+    {
+        return tracks;
+    }
+
+    const MIDITempoMap &GetTempoMap() const
+    {
+        return tempo_map;
+    }
+
+    int GetNumMarkers() const
+    {
+        return ( int ) marker_names.size();
+    }
+
+    const std::string &GetMarkerName ( int n ) const
+    {
+        return marker_names[n];
+    }
+
+    MIDIClockTime GetMarkerTime ( int n ) const
+    {
+        return marker_times[n];
+    }
+
+    // install the song into seq like AdvancedSequencer::Load(). the tracks are moved, so the
+    // loader is idle afterwards. return false if the load is not ready
+    bool Commit ( AdvancedSequencer *seq );
+
+protected:
+    static const int NUM_PROGRESS_STAGES = STAGE_WARP_INDEX - STAGE_READ + 1;
+
+    void ThreadProc();
+
+    bool ReadFile();
+    bool DecodeTracks();
+    void BuildTempoMap();
+    bool BuildWarpIndex();
+
+    bool IsCancelled() const
+    {
+        return cancel_request;
+    }
+
+    void SetProgress ( Stage s, float f )
+    {
+        progress[s - STAGE_READ] = f;
+    }
+
+    int num_threads;
+    std::string file_name;
+
+    std::vector<unsigned char> file_data;
+    MIDIMultiTrack tracks;
+    MIDIClockTime music_end_clock;
+    MIDITempoMap tempo_map;
+    std::vector<std::string> marker_names;
+    std::vector<MIDIClockTime> marker_times;
+    MIDISequencerSnapshotNames warp_names;
+    std::vector<MIDISequencerSnapshot> warp_snapshots;
+
+    std::atomic<int> stage;
+    std::atomic<float> progress[NUM_PROGRESS_STAGES];
+    std::atomic<bool> cancel_request;
+    std::thread thread;
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_SYSEXPOOL_H
+#define JDKSMIDI_SYSEXPOOL_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/sysex.h"
+
+#include <unordered_map>
+
+namespace jdksmidi
+{
+
+class MIDISysExPool;
+
+///
+/// MIDISysExPool stores sysex and meta event data as immutable blobs. Equal data is stored only
+/// once (GS/XG files repeat the same few sysex messages many times), so a message which refers
+/// to a blob is copied by copying its blob number. Blobs stay valid until Clear().
+///
+
+class MIDISysExPool
+{
+public:
+    enum
+    {
+        NO_BLOB = -1
+    };
+
+    MIDISysExPool();
+    virtual ~MIDISysExPool();
+
+    void Clear();
+
+    // return the number of the blob with data, added to the pool if it is not there yet
+    long Intern ( const unsigned char *data, int len );
+
+    long Intern ( const MIDISystemExclusive &sysex )
+    {
+        return Intern ( sysex.GetBuf(), sysex.GetLengthSE() );
+    }
+
+    int GetLength ( long blob ) const
+    {
+        return blobs[blob].length;
+    }
+
+    // return the blob data, 0 for an empty blob
+    const unsigned char *GetData ( long blob ) const
+    {
+        return blobs[blob].length > 0 ? &data[blobs[blob].offset] : 0;
+    }
+
+    long GetNumBlobs() const
+    {
+        return ( long ) blobs.size();
+    }
+
+    // number of bytes of all different blobs
+    unsigned long GetDataSize() const
+    {
+        return ( unsigned long ) data.size();
+    }
+
+protected:
+    struct Blob
+    {
+        unsigned long offset;
+        int length;
+    };
+
+    static unsigned long Hash ( const unsigned char *data, int len );
+
+    std::vector<Blob> blobs;
+    std::vector<unsigned char> data;
+
+    // hash of the data to the first blob with this hash, collisions are chained in next_blob
+    std::unordered_map<unsigned long, long> blob_by_hash;
+    std::vector<long> next_blob;
+};
+
+}
+
+#endif
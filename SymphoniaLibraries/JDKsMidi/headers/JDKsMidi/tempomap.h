@@ -0,0 +1,176 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_TEMPOMAP_H
+#define JDKSMIDI_TEMPOMAP_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/msg.h"
+#include "jdksmidi/multitrack.h"
+
+namespace jdksmidi
+{
+
+class MIDITempoMap;
+class MIDITempoMapCursor;
+
+///
+/// MIDITempoMap is built once from the tempo events of the conductor track and converts midi
+/// clock times to milliseconds (and back) without playing the song through a MIDISequencer.
+/// Each tempo change starts a segment with its clock, tempo and the ms time at its start, so
+/// a conversion is a binary search for the segment plus one multiply. The times are for tempo
+/// scale 100%.
+///
+
+class MIDITempoMap
+{
+public:
+    struct Segment
+    {
+        MIDIClockTime clock;         // start of segment
+        unsigned long us_per_quarter; // tempo in the segment
+        double ms;                   // time at start of segment
+        double ms_per_clock;
+    };
+
+    MIDITempoMap();
+    virtual ~MIDITempoMap();
+
+    void Clear();
+
+    // build the map from the tempo events of track conductor_track of multitrack
+    void Build ( const MIDIMultiTrack *multitrack, int conductor_track = 0 );
+
+    double ClockToMs ( MIDIClockTime clock ) const
+    {
+        return SegmentClockToMs ( segments[FindSegmentOfClock ( clock )], clock );
+    }
+
+    MIDIClockTime MsToClock ( double ms ) const
+    {
+        return SegmentMsToClock ( segments[FindSegmentOfMs ( ms )], ms );
+    }
+
+    // tempo in beats per minute at clock
+    double GetTempoBPM ( MIDIClockTime clock ) const
+    {
+        return 60000000.0 / segments[FindSegmentOfClock ( clock )].us_per_quarter;
+    }
+
+    // time of the last event which is not end of track, in ms
+    double GetMusicDurationInMilliseconds() const
+    {
+        return ClockToMs ( music_end_clock );
+    }
+
+    MIDIClockTime GetMusicEndClock() const
+    {
+        return music_end_clock;
+    }
+
+    int GetClksPerBeat() const
+    {
+        return clks_per_beat;
+    }
+
+    int GetNumSegments() const
+    {
+        return ( int ) segments.size();
+    }
+
+    const Segment &GetSegment ( int seg ) const
+    {
+        return segments[seg];
+    }
+
+    // number of last segment which starts at or before clock
+    int FindSegmentOfClock ( MIDIClockTime clock ) const;
+
+    // number of last segment which starts at or before ms
+    int FindSegmentOfMs ( double ms ) const;
+
+    static double SegmentClockToMs ( const Segment &seg, MIDIClockTime clock )
+    {
+        return seg.ms + ( double ) ( clock - seg.clock ) * seg.ms_per_clock;
+    }
+
+    static MIDIClockTime SegmentMsToClock ( const Segment &seg, double ms )
+    {
+        return seg.clock + ( MIDIClockTime ) ( ( ms - seg.ms ) / seg.ms_per_clock + 0.5 );
+    }
+
+protected:
+    void AddSegment ( MIDIClockTime clock, unsigned long us_per_quarter );
+
+    int clks_per_beat;
+    MIDIClockTime music_end_clock;
+    std::vector<Segment> segments; // sorted by clock, never empty
+};
+
+///
+/// MIDITempoMapCursor converts increasing times with a MIDITempoMap. It remembers the segment
+/// of the last conversion and only steps forward from there, so walking through a song costs
+/// O(1) per conversion. Going back in time falls back to a binary search.
+///
+
+class MIDITempoMapCursor
+{
+public:
+    explicit MIDITempoMapCursor ( const MIDITempoMap *map_ )
+        : map ( map_ ), seg ( 0 )
+    {
+    }
+
+    void Reset()
+    {
+        seg = 0;
+    }
+
+    double ClockToMs ( MIDIClockTime clock )
+    {
+        SeekClock ( clock );
+        return MIDITempoMap::SegmentClockToMs ( map->GetSegment ( seg ), clock );
+    }
+
+    double GetTempoBPM ( MIDIClockTime clock )
+    {
+        SeekClock ( clock );
+        return 60000000.0 / map->GetSegment ( seg ).us_per_quarter;
+    }
+
+protected:
+    void SeekClock ( MIDIClockTime clock )
+    {
+        if ( clock < map->GetSegment ( seg ).clock )
+        {
+            seg = map->FindSegmentOfClock ( clock );
+            return;
+        }
+
+        while ( seg + 1 < map->GetNumSegments() && map->GetSegment ( seg + 1 ).clock <= clock )
+            ++seg;
+    }
+
+    const MIDITempoMap *map;
+    int seg;
+};
+
+}
+
+#endif
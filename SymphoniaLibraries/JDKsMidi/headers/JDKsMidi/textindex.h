@@ -0,0 +1,129 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_TEXTINDEX_H
+#define JDKSMIDI_TEXTINDEX_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/multitrack.h"
+#include "jdksmidi/tempomap.h"
+#include "jdksmidi/sysexpool.h"
+
+#include <string>
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDITextIndex;
+
+///
+/// MIDITextIndex keeps every text meta event of a song (markers, lyrics, track names, cue
+/// points...) with its clock, ms and track, sorted by time, so "the events in [t0, t1)" is
+/// two binary searches; a karaoke display can ask for the lyrics of each frame without
+/// walking the tracks. Every event type also has a list of its own for queries of one type.
+/// The texts are interned in one MIDISysExPool, so repeated texts are stored once. The texts
+/// are not 0 terminated.
+///
+
+class MIDITextIndex
+{
+public:
+    enum
+    {
+        ALL_TYPES = 0xfffe  // bit n is meta type n, 1...15
+    };
+
+    struct Entry
+    {
+        MIDIClockTime clock;
+        double ms;          // at tempo scale 100%
+        int track;
+        int type;           // META_GENERIC_TEXT...META_GENERIC_TEXT_F
+        long text;          // blob in the text pool
+    };
+
+    MIDITextIndex();
+    virtual ~MIDITextIndex();
+
+    void Clear();
+
+    // index the text events of the types in type_mask of all tracks of multitrack
+    void Build ( const MIDIMultiTrack *multitrack, const MIDITempoMap &tempo_map, unsigned int type_mask = ALL_TYPES );
+
+    int GetNumEntries() const
+    {
+        return ( int ) entries.size();
+    }
+
+    const Entry &GetEntry ( int n ) const
+    {
+        return entries[n];
+    }
+
+    // text of entry n and its length, 0 for an empty text
+    const char *GetText ( int n, int *len ) const
+    {
+        *len = text_pool.GetLength ( entries[n].text );
+        return ( const char * ) text_pool.GetData ( entries[n].text );
+    }
+
+    std::string GetString ( int n ) const
+    {
+        int len;
+        const char *text = GetText ( n, &len );
+        return text ? std::string ( text, len ) : std::string();
+    }
+
+    // the entries in [first, end) are the events at clock t0 up to before t1
+    void FindRange ( MIDIClockTime t0, MIDIClockTime t1, int *first, int *end ) const;
+
+    // the same for ms
+    void FindRangeMs ( double ms0, double ms1, int *first, int *end ) const;
+
+    // the events of one type, k counts the events of the type
+    int GetNumEntriesOfType ( int type ) const
+    {
+        return ( int ) entries_of_type[type & 0x0f].size();
+    }
+
+    // entry number of the k-th event of type
+    int GetEntryOfType ( int type, int k ) const
+    {
+        return entries_of_type[type & 0x0f][k];
+    }
+
+    // k of the events of type in [t0, t1) are in [first, end)
+    void FindRangeOfType ( int type, MIDIClockTime t0, MIDIClockTime t1, int *first, int *end ) const;
+    void FindRangeOfTypeMs ( int type, double ms0, double ms1, int *first, int *end ) const;
+
+    const MIDISysExPool &GetTextPool() const
+    {
+        return text_pool;
+    }
+
+protected:
+    std::vector<Entry> entries;               // sorted by clock, then track
+    std::vector<int> entries_of_type[16];     // entry numbers of every type, sorted
+    MIDISysExPool text_pool;
+};
+
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_TIMECODE_H
+#define JDKSMIDI_TIMECODE_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/smpte.h"
+#include "jdksmidi/tempomap.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace jdksmidi
+{
+
+class MIDITimecode;
+
+///
+/// MIDITimecodeFields is a timecode as hours:minutes:seconds:frames.sub_frames.
+///
+
+struct MIDITimecodeFields
+{
+    int hours;
+    int minutes;
+    int seconds;
+    int frames;
+    int sub_frames;
+};
+
+///
+/// MIDITimecode converts between audio sample positions, SMPTE timecode and midi clock with
+/// integer arithmetic only, so a conversion is exact and a round trip gives the same value.
+/// Unlike SMPTE it takes any sample rate in Hz and any frame rate as a fraction (30000/1001
+/// for 29.97), with drop frame for 29.97 and 59.94, and any number of sub frames per frame.
+///
+/// Sample positions are counted from 0 and must not be negative. A sample position belongs to
+/// the sub frame (or midi clock) it lies in; the conversions the other way give the first
+/// sample at or after the start of the sub frame (or midi clock).
+///
+/// Midi clock conversions need the tempo of the song from SetTempoMap(). The time of each tempo
+/// change is kept as an integer in 1/division microseconds, so times do not drift over a song.
+///
+
+class MIDITimecode
+{
+public:
+    MIDITimecode ( int64_t sample_rate_ = 48000, int fps_num_ = 30, int fps_den_ = 1, bool drop_frame_ = false, int sub_frames_per_frame_ = 100 );
+    virtual ~MIDITimecode();
+
+    void SetSampleRate ( int64_t rate )
+    {
+        sample_rate = rate;
+    }
+
+    int64_t GetSampleRate() const
+    {
+        return sample_rate;
+    }
+
+    // frame rate fps_num_/fps_den_, return false if drop frame is asked for a rate without it
+    bool SetFrameRate ( int fps_num_, int fps_den_ = 1, bool drop_frame_ = false );
+
+    // frame rate of an SMPTE_RATE
+    bool SetFrameRate ( SMPTE_RATE r );
+
+    void SetSubFramesPerFrame ( int n )
+    {
+        sub_frames_per_frame = n;
+    }
+
+    int GetSubFramesPerFrame() const
+    {
+        return sub_frames_per_frame;
+    }
+
+    bool IsDropFrame() const
+    {
+        return drop_frame;
+    }
+
+    // whole frames per second of the timecode, 30 for 29.97
+    int GetNominalFrameRate() const
+    {
+        return nominal_fps;
+    }
+
+    //
+    // frame numbers and timecode fields
+    //
+
+    void FrameToFields ( int64_t frame, MIDITimecodeFields *tc ) const;
+    int64_t FieldsToFrame ( const MIDITimecodeFields &tc ) const;
+
+    //
+    // samples and sub frames, counted from 0
+    //
+
+    int64_t SampleToSubFrame ( int64_t sample ) const
+    {
+        return MulDiv ( sample, ( int64_t ) fps_num * sub_frames_per_frame, sample_rate * fps_den );
+    }
+
+    int64_t SubFrameToSample ( int64_t sub_frame ) const
+    {
+        return MulDivCeil ( sub_frame, sample_rate * fps_den, ( int64_t ) fps_num * sub_frames_per_frame );
+    }
+
+    void SampleToFields ( int64_t sample, MIDITimecodeFields *tc ) const;
+    int64_t FieldsToSample ( const MIDITimecodeFields &tc ) const;
+
+    //
+    // samples and midi clock
+    //
+
+    // take the tempo changes of tempo_map
+    void SetTempoMap ( const MIDITempoMap &tempo_map );
+
+    int64_t ClockToSample ( MIDIClockTime clock ) const
+    {
+        return ClockUnitsToSample ( SegmentClockToUnits ( segments[FindSegmentOfClock ( clock )], clock ) );
+    }
+
+    MIDIClockTime SampleToClock ( int64_t sample ) const
+    {
+        int64_t units = SampleToClockUnits ( sample );
+        return SegmentUnitsToClock ( segments[FindSegmentOfUnits ( units )], units );
+    }
+
+    //
+    // batch conversions of num values. the input does not have to be sorted, but sorted
+    // input only steps through the tempo segments once
+    //
+
+    void ClocksToSamples ( const MIDIClockTime *clocks, int64_t *samples, int num ) const;
+    void SamplesToClocks ( const int64_t *samples, MIDIClockTime *clocks, int num ) const;
+    void SamplesToFields ( const int64_t *samples, MIDITimecodeFields *tcs, int num ) const;
+    void FieldsToSamples ( const MIDITimecodeFields *tcs, int64_t *samples, int num ) const;
+
+    // floor ( a * b / c ) and ceil ( a * b / c ) for a >= 0, b >= 0, c > 0, without overflow
+    // of a * b as long as ( c - 1 ) * b fits
+    static int64_t MulDiv ( int64_t a, int64_t b, int64_t c )
+    {
+        return ( a / c ) * b + ( a % c ) * b / c;
+    }
+
+    static int64_t MulDivCeil ( int64_t a, int64_t b, int64_t c )
+    {
+        return ( a / c ) * b + ( ( a % c ) * b + c - 1 ) / c;
+    }
+
+protected:
+    struct Segment
+    {
+        MIDIClockTime clock;          // start of segment
+        int64_t us_per_quarter;
+        int64_t units;                // time of start in 1/division us
+    };
+
+    static int64_t SegmentClockToUnits ( const Segment &seg, MIDIClockTime clock )
+    {
+        return seg.units + ( int64_t ) ( clock - seg.clock ) * seg.us_per_quarter;
+    }
+
+    static MIDIClockTime SegmentUnitsToClock ( const Segment &seg, int64_t units )
+    {
+        return seg.clock + ( MIDIClockTime ) ( ( units - seg.units ) / seg.us_per_quarter );
+    }
+
+    int64_t ClockUnitsToSample ( int64_t units ) const
+    {
+        return MulDivCeil ( units, sample_rate, ( int64_t ) division * 1000000 );
+    }
+
+    int64_t SampleToClockUnits ( int64_t sample ) const
+    {
+        return MulDiv ( sample, ( int64_t ) division * 1000000, sample_rate );
+    }
+
+    int FindSegmentOfClock ( MIDIClockTime clock ) const;
+    int FindSegmentOfUnits ( int64_t units ) const;
+
+    int64_t sample_rate;
+    int fps_num;
+    int fps_den;
+    int nominal_fps;
+    bool drop_frame;
+    int drop_frames;                  // frames dropped each minute
+    int sub_frames_per_frame;
+
+    int division;
+    std::vector<Segment> segments;    // sorted by clock, never empty
+};
+
+}
+
+#endif
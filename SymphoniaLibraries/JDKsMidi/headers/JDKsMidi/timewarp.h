@@ -0,0 +1,116 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_TIMEWARP_H
+#define JDKSMIDI_TIMEWARP_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/tempomap.h"
+
+namespace jdksmidi
+{
+
+class MIDITimeWarp;
+
+///
+/// MIDITimeWarp maps wall clock time to song time (ms at tempo scale 100%, as in MIDITempoMap)
+/// for a speed which can change at any time. Every change of speed adds an anchor with the
+/// wall time, the song time and the new scale at that moment, so the mapping stays continuous:
+/// the song time does not jump when the speed changes and nothing has to seek. The mapping
+/// with the last anchor is O(1); earlier times are found with a binary search.
+///
+
+class MIDITimeWarp
+{
+public:
+    struct Anchor
+    {
+        double wall_ms;
+        double song_ms;
+        double scale;   // song ms per wall ms, 1.0 = normal speed, 0 = paused
+    };
+
+    MIDITimeWarp();
+    virtual ~MIDITimeWarp();
+
+    // start again with song_ms at wall_ms, at speed scale
+    void Reset ( double wall_ms = 0.0, double song_ms = 0.0, double scale = 1.0 );
+
+    // change the speed from wall_ms on, wall_ms must not be before the last anchor
+    void SetScale ( double wall_ms, double scale );
+
+    // jump to song_ms at wall_ms, keeping the speed
+    void Seek ( double wall_ms, double song_ms );
+
+    double GetScale() const
+    {
+        return anchors.back().scale;
+    }
+
+    // song time at wall_ms, for wall_ms at or after the last anchor
+    double WallToSong ( double wall_ms ) const
+    {
+        return AnchorWallToSong ( anchors.back(), wall_ms );
+    }
+
+    // song time at any wall_ms since the last Reset()
+    double WallToSongAt ( double wall_ms ) const
+    {
+        return AnchorWallToSong ( anchors[FindAnchorOfWall ( wall_ms )], wall_ms );
+    }
+
+    // wall time at which song_ms is played, or the wall time of the pause if the warp is paused
+    // at song_ms. only for song times played since the last Reset() or Seek()
+    double SongToWall ( double song_ms ) const;
+
+    // song time at wall_ms as midi clock
+    MIDIClockTime WallToClock ( double wall_ms, const MIDITempoMap &tempo_map ) const
+    {
+        return tempo_map.MsToClock ( WallToSong ( wall_ms ) );
+    }
+
+    // forget anchors which are not needed for times at or after wall_ms
+    void DiscardBefore ( double wall_ms );
+
+    int GetNumAnchors() const
+    {
+        return ( int ) anchors.size();
+    }
+
+    const Anchor &GetAnchor ( int n ) const
+    {
+        return anchors[n];
+    }
+
+    static double AnchorWallToSong ( const Anchor &a, double wall_ms )
+    {
+        return a.song_ms + ( wall_ms - a.wall_ms ) * a.scale;
+    }
+
+protected:
+    // number of last anchor at or before wall_ms
+    int FindAnchorOfWall ( double wall_ms ) const;
+
+    std::vector<Anchor> anchors; // sorted by wall time, never empty
+    int first_after_seek;        // song time only increases from this anchor on
+};
+
+}
+
+#endif
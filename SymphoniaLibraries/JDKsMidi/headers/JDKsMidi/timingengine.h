@@ -0,0 +1,241 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JDKSMIDI_TIMINGENGINE_H
+#define JDKSMIDI_TIMINGENGINE_H
+
+#include "jdksmidi/midi.h"
+#include "jdksmidi/tick.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+namespace jdksmidi
+{
+
+class MIDITimingClock;
+class MIDITimingSteadyClock;
+class MIDITimingVirtualClock;
+class MIDITimingEngine;
+
+///
+/// MIDITimingClock is the time source of a MIDITimingEngine, in nanoseconds from any start.
+///
+
+class MIDITimingClock
+{
+public:
+    MIDITimingClock()
+    {
+    }
+
+    virtual ~MIDITimingClock()
+    {
+    }
+
+    virtual int64_t GetTimeNs() const = 0;
+
+    // wait until time deadline_ns, return at once if it has passed
+    virtual void WaitUntilNs ( int64_t deadline_ns ) = 0;
+};
+
+///
+/// MIDITimingSteadyClock is the real time clock on std::chrono::steady_clock. WaitUntilNs()
+/// sleeps until spin_ns before the deadline and then spins for the rest, since the thread
+/// usually wakes up late from a sleep. The time spent in both is counted separately.
+///
+
+class MIDITimingSteadyClock : public MIDITimingClock
+{
+public:
+    explicit MIDITimingSteadyClock ( int64_t spin_ns_ = 200000 );
+    virtual ~MIDITimingSteadyClock();
+
+    virtual int64_t GetTimeNs() const;
+    virtual void WaitUntilNs ( int64_t deadline_ns );
+
+    // 0 never spins, the whole wait is a sleep
+    void SetSpinTimeNs ( int64_t ns )
+    {
+        spin_ns = ns;
+    }
+
+    int64_t GetSpinTimeNs() const
+    {
+        return spin_ns;
+    }
+
+    int64_t GetTotalSleepNs() const
+    {
+        return total_sleep_ns;
+    }
+
+    int64_t GetTotalSpinNs() const
+    {
+        return total_spin_ns;
+    }
+
+protected:
+    int64_t spin_ns;
+
+    // written by the engine thread, read by the getters while it runs
+    std::atomic<int64_t> total_sleep_ns;
+    std::atomic<int64_t> total_spin_ns;
+};
+
+///
+/// MIDITimingVirtualClock is a clock which only goes forward when it is waited on or set, so
+/// a sequence can be run as fast as possible (for example in tests without a midi device)
+/// with the same times it would see in real time.
+///
+
+class MIDITimingVirtualClock : public MIDITimingClock
+{
+public:
+    MIDITimingVirtualClock()
+        : now_ns ( 0 )
+    {
+    }
+
+    virtual ~MIDITimingVirtualClock()
+    {
+    }
+
+    virtual int64_t GetTimeNs() const
+    {
+        return now_ns;
+    }
+
+    virtual void WaitUntilNs ( int64_t deadline_ns )
+    {
+        if ( deadline_ns > now_ns )
+            now_ns = deadline_ns;
+    }
+
+    void SetTimeNs ( int64_t ns )
+    {
+        now_ns = ns;
+    }
+
+    void AdvanceNs ( int64_t ns )
+    {
+        now_ns += ns;
+    }
+
+protected:
+    int64_t now_ns;
+};
+
+///
+/// MIDITimingEngine calls TimeTick() of a MIDITick (a MIDIManager or MIDIDriver) every period.
+/// The ticks are scheduled on absolute deadlines start + n * period, so a late tick does not
+/// move the later ones and the timing does not drift. The time given to TimeTick() is the
+/// deadline in ms since Start(), plus the time offset.
+///
+
+class MIDITimingEngine
+{
+public:
+    MIDITimingEngine ( MIDITick *tick_, MIDITimingClock *clock_, int64_t period_ns_ = 1000000 );
+    virtual ~MIDITimingEngine();
+
+    // run the ticks on a thread of its own, return false if it is running already
+    bool Start();
+
+    // stop the thread and wait for it
+    void Stop();
+
+    bool IsRunning() const
+    {
+        return running;
+    }
+
+    // run the ticks on this thread for duration_ns of clock time. with a
+    // MIDITimingVirtualClock this runs as fast as possible
+    void Run ( int64_t duration_ns );
+
+    void SetPeriodNs ( int64_t ns )
+    {
+        period_ns = ns;
+    }
+
+    int64_t GetPeriodNs() const
+    {
+        return period_ns;
+    }
+
+    // ms added to the time given to TimeTick()
+    void SetTimeOffsetMs ( unsigned long ms )
+    {
+        time_offset_ms = ms;
+    }
+
+    // clock time since the first tick
+    int64_t GetElapsedNs() const
+    {
+        return clock->GetTimeNs() - start_ns;
+    }
+
+    unsigned long GetNumTicks() const
+    {
+        return num_ticks;
+    }
+
+    // ticks which were called more than one period after their deadline
+    unsigned long GetNumLateTicks() const
+    {
+        return num_late_ticks;
+    }
+
+    int64_t GetMaxLatenessNs() const
+    {
+        return max_lateness_ns;
+    }
+
+protected:
+    // start a new schedule at the current clock time
+    void Begin();
+
+    // wait for the next deadline and tick
+    void Step();
+
+    void ThreadProc();
+
+    MIDITick *tick;
+    MIDITimingClock *clock;
+    int64_t period_ns;
+    unsigned long time_offset_ms;
+
+    int64_t start_ns;
+    int64_t next_deadline_ns;
+
+    // written by the engine thread, read by the getters while it runs
+    std::atomic<unsigned long> num_ticks;
+    std::atomic<unsigned long> num_late_ticks;
+    std::atomic<int64_t> max_lateness_ns;
+
+    std::atomic<bool> running;
+    std::atomic<bool> stop_request;
+    std::thread thread;
+};
+
+}
+
+#endif
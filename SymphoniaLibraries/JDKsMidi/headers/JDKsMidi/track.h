@@ -115,6 +115,23 @@ public:
     ///
     MIDITrack ( const MIDITrack &t );
 
+    ///
+    /// Move Constructor for a MIDITrack object, takes over the chunks of t and leaves t empty
+    /// @param t The reference to the MIDITrack object to move from
+    ///
+    MIDITrack ( MIDITrack &&t ) noexcept
+        : buf_size ( t.buf_size ), num_events ( t.num_events )
+    {
+        for ( int i = 0; i < MIDIChunksPerTrack; ++i )
+        {
+            chunk[i] = t.chunk[i];
+            t.chunk[i] = 0;
+        }
+
+        t.buf_size = 0;
+        t.num_events = 0;
+    }
+
     ///
     /// The MIDITrack Destructor, frees all chunks and referenced MIDITimedBigMessage's
     ///
@@ -145,8 +162,34 @@ public:
 
     const MIDITrack & operator = ( const MIDITrack & src );
 
+    // swap the chunks with src, the old events of this track are freed with src
+    const MIDITrack & operator = ( MIDITrack && src ) noexcept
+    {
+        if ( this != &src )
+        {
+            for ( int i = 0; i < MIDIChunksPerTrack; ++i )
+                std::swap ( chunk[i], src.chunk[i] );
+
+            std::swap ( buf_size, src.buf_size );
+            std::swap ( num_events, src.num_events );
+        }
+
+        return *this;
+    }
+
     bool Expand ( int increase_amount = ( MIDITrackChunkSize ) );
 
+    // set the number of events to n, up to the buffer size, so the events after the old
+    // last one can be written in place with GetEventAddress(). they keep what they hold
+    bool SetNumEvents ( int n )
+    {
+        if ( n < 0 || n > buf_size )
+            return false;
+
+        num_events = n;
+        return true;
+    }
+
     MIDITimedBigMessage * GetEventAddress ( int event_num );
 
     const MIDITimedBigMessage * GetEventAddress ( int event_num ) const;
@@ -169,6 +212,16 @@ public:
 
     bool PutEvent ( const MIDITimedBigMessage &msg );
 
+    // put event and take over its sysex instead of copying it
+    bool PutEvent ( MIDITimedBigMessage &&msg )
+    {
+        if ( num_events >= buf_size && !Expand() )
+            return false;
+
+        *GetEventAddress ( num_events++ ) = std::move ( msg );
+        return true;
+    }
+
     bool PutEvent ( const MIDIDeltaTimedMessage &msg )
     {
         return PutEvent ( MIDIDeltaTimedBigMessage (msg) );
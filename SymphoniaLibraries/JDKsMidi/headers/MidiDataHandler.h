@@ -1,8 +1,15 @@
 #ifndef _MIDIDATAHANDLER_H_
 #define _MIDIDATAHANDLER_H_
 
+#include <stddef.h>
+
 #define MIDI_CHANNELS_COUNT 16
 
+namespace jdksmidi
+{
+	class MIDIFileReadStreamBlock;
+}
+
 
 class MidiDataHandler
 {
@@ -12,6 +19,7 @@ public:
 	~MidiDataHandler();
 
 	bool Parse(const char* midiFilePath);
+	bool Parse(const unsigned char* midiData, size_t midiDataLength);
 
 	double GetMidiDuration() const;
 	int GetActiveChannelsCount() const;
@@ -20,6 +28,8 @@ public:
 
 private:
 
+	bool ParseStream(jdksmidi::MIDIFileReadStreamBlock* midiFileReadStream);
+
 	class MidiChannelInfo* m_midiChannels;
 	double m_midiDuration;
 };
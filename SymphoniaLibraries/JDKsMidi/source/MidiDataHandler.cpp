@@ -2,9 +2,12 @@
 #include "MidiChannelInfo.h"
 #include "jdksmidi/world.h"
 #include "jdksmidi/filereadmultitrack.h"
+#include "jdksmidi/filereadsysex.h"
+#include "jdksmidi/filereadblock.h"
 #include "jdksmidi/manager.h"
 #include "jdksmidi/driverdump.h"
 #include "jdksmidi/driver.h"
+#include "jdksmidi/tempomap.h"
 
 
 MidiDataHandler::MidiDataHandler()
@@ -31,19 +34,47 @@ MidiDataHandler::~MidiDataHandler()
 
 bool MidiDataHandler::Parse(const char* midiFilePath)
 {
-	jdksmidi::MIDIFileReadStreamFile midiFileReadStream(midiFilePath);
+	// Whole file is pulled into memory with one read, then the tracks are decoded from there
+	jdksmidi::MIDIFileReadStreamBufferedFile midiFileReadStream(midiFilePath);
+	if (midiFileReadStream.IsValid() == false)
+	{
+		return false;
+	}
+
+	return ParseStream(&midiFileReadStream);
+}
+
+bool MidiDataHandler::Parse(const unsigned char* midiData, size_t midiDataLength)
+{
+	// Midi file that is already in memory (eg. TextAsset bytes from Unity). Not copied, only read during the parse.
+	jdksmidi::MIDIFileReadStreamMemory midiFileReadStream(midiData, (unsigned long)midiDataLength);
+	if (midiFileReadStream.IsValid() == false)
+	{
+		return false;
+	}
+
+	return ParseStream(&midiFileReadStream);
+}
+
+bool MidiDataHandler::ParseStream(jdksmidi::MIDIFileReadStreamBlock* midiFileReadStream)
+{
 	jdksmidi::MIDIMultiTrack tracks(64);
-	jdksmidi::MIDIFileReadMultiTrack track_loader(&tracks);
-	jdksmidi::MIDIFileRead reader(&midiFileReadStream, &track_loader);
+	// Sysex is never used for the channel info, so it is not loaded at all
+	jdksmidi::MIDIFileReadMultiTrackSysEx track_loader(&tracks, jdksmidi::MIDIFileReadMultiTrackSysEx::SYSEX_SKIP);
+	jdksmidi::MIDIFileReadBlock reader(midiFileReadStream, &track_loader);
 	reader.Parse();
 
+	// Times and tempos come from the tempo map, so the song is not played through to get them
+	jdksmidi::MIDITempoMap tempoMap;
+	tempoMap.Build(&tracks);
+	jdksmidi::MIDITempoMapCursor tempoMapCursor(&tempoMap);
+
 	// Create JDKsMidi Sequencer Which will read through the tracks
 	jdksmidi::MIDISequencer seq(&tracks);
 	seq.GoToZero();
 
 	// Get Total Midi Time
-	m_midiDuration = seq.GetMisicDurationInSeconds();
-	seq.GoToZero();
+	m_midiDuration = seq.GetMusicDurationInMilliseconds(tempoMap) * 0.001;
 
 	// In the next Function, these will both be changed
 	int trackID = 0;
@@ -67,8 +98,8 @@ bool MidiDataHandler::Parse(const char* midiFilePath)
 			MidiEvent* midiEvent = new MidiEvent();
 			{
 				midiEvent->noteID = noteID;
-				midiEvent->activationTime = (float)(seq.GetCurrentTimeInMs() * 0.001);
-				midiEvent->tempo = seq.GetCurrentTempo();
+				midiEvent->activationTime = (float)(tempoMapCursor.ClockToMs(midiEventMessage.GetTime()) * 0.001);
+				midiEvent->tempo = tempoMapCursor.GetTempoBPM(midiEventMessage.GetTime());
 
 				if ((midiEventMessage.status & 0xf0) == jdksmidi::NOTE_OFF)
 				{
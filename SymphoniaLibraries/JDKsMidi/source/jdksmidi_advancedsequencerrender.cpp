@@ -0,0 +1,154 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/advancedsequencer.h"
+#include "jdksmidi/filewritebuffered.h"
+
+namespace jdksmidi
+{
+
+// true if any track of multitrack has a tempo event at time 0
+static bool HasStartTempo ( const MIDIMultiTrack *multitrack )
+{
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = 0; i < track->GetNumEvents() && track->GetEventAddress ( i )->GetTime() == 0; ++i )
+        {
+            if ( track->GetEventAddress ( i )->IsTempo() )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// play seq from the start and give every event that goes out to put ( track, msg, time_ms ).
+// the state of seq is restored at the end
+template <class PutFunction>
+static bool RenderSequencer ( MIDISequencer *seq, const MIDIMultiTrack *multitrack, PutFunction put )
+{
+    MIDISequencerState saved_state ( *seq->GetState() );
+
+    double tempo_scale = seq->GetCurrentTempoScale();
+    bool scale_tempo = ( tempo_scale > 0.0 && tempo_scale != 1.0 );
+    bool ok = true;
+    int trk;
+    MIDITimedBigMessage msg;
+
+    // a song without a tempo at the start plays at 120 bpm, which must be scaled too
+    if ( scale_tempo && !HasStartTempo ( multitrack ) )
+    {
+        msg.SetTempo ( ( unsigned long ) ( 500000 / tempo_scale + 0.5 ) );
+        msg.SetTime ( 0 );
+        ok = put ( 0, msg, 0.0 );
+    }
+
+    seq->GoToZero();
+
+    while ( ok && seq->GetNextEvent ( &trk, &msg ) )
+    {
+        if ( msg.IsBeatMarker() || msg.IsNoOp() )
+            continue;
+
+        // events of muted tracks (or tracks not solo in solo mode) are not sent out
+        if ( msg.IsChannelMsg() )
+        {
+            const MIDISequencerTrackProcessor *proc = seq->GetTrackProcessor ( trk );
+
+            if ( proc->mute || ( seq->GetSoloMode() && !proc->solo ) )
+                continue;
+        }
+
+        if ( scale_tempo && msg.IsTempo() )
+            msg.SetTempo ( ( unsigned long ) ( msg.GetTempo() / tempo_scale + 0.5 ) );
+
+        ok = put ( trk, msg, seq->GetCurrentTimeInMs() );
+    }
+
+    seq->SetState ( &saved_state );
+    return ok;
+}
+
+bool AdvancedSequencer::RenderToBuffer ( std::vector< MIDITimedBigMessage > *events,
+        std::vector< int > *event_tracks,
+        std::vector< double > *event_times_ms )
+{
+    if ( !file_loaded || IsPlay() )
+        return false;
+
+    events->clear();
+
+    if ( event_tracks )
+        event_tracks->clear();
+
+    if ( event_times_ms )
+        event_times_ms->clear();
+
+    return RenderSequencer ( &seq, &tracks, [&] ( int trk, MIDITimedBigMessage & msg, double time_ms )
+    {
+        events->push_back ( std::move ( msg ) );
+
+        if ( event_tracks )
+            event_tracks->push_back ( trk );
+
+        if ( event_times_ms )
+            event_times_ms->push_back ( time_ms );
+
+        return true;
+    } );
+}
+
+bool AdvancedSequencer::RenderToMultiTrack ( MIDIMultiTrack *dest )
+{
+    if ( !file_loaded || IsPlay() )
+        return false;
+
+    int num_tracks = seq.GetNumTracks();
+
+    if ( !dest->ClearAndResize ( num_tracks ) )
+        return false;
+
+    dest->SetClksPerBeat ( tracks.GetClksPerBeat() );
+
+    return RenderSequencer ( &seq, &tracks, [&] ( int trk, MIDITimedBigMessage & msg, double )
+    {
+        return dest->GetTrack ( trk )->PutEvent ( std::move ( msg ) );
+    } );
+}
+
+bool AdvancedSequencer::RenderToFile ( const char *fname )
+{
+    MIDIMultiTrack rendered;
+
+    if ( !RenderToMultiTrack ( &rendered ) )
+        return false;
+
+    MIDIFileWriteStreamBlockFile out_stream ( fname );
+
+    if ( !out_stream.IsValid() )
+        return false;
+
+    MIDIFileWriteMultiTrackBuffered writer ( &rendered, &out_stream );
+    return writer.Write ( rendered.GetNumTracksWithEvents() );
+}
+
+}
@@ -0,0 +1,204 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/beatgrid.h"
+
+#include <algorithm>
+
+namespace jdksmidi
+{
+
+MIDIBeatGrid::MIDIBeatGrid()
+{
+    Clear();
+}
+
+MIDIBeatGrid::~MIDIBeatGrid()
+{
+}
+
+void MIDIBeatGrid::Clear()
+{
+    tempo_map = 0;
+    clks_per_beat = 120;
+    timesigs.clear();
+    measure_clock.clear();
+    measure_ms.clear();
+
+    AddTimeSig ( 0, 4, 4 );
+    measure_clock.push_back ( 0 );
+    measure_ms.push_back ( 0.0 );
+}
+
+void MIDIBeatGrid::Build ( const MIDIMultiTrack *multitrack, const MIDITempoMap &tempo_map_ )
+{
+    Clear();
+    measure_clock.clear();
+    measure_ms.clear();
+
+    tempo_map = &tempo_map_;
+    clks_per_beat = multitrack->GetClksPerBeat();
+    timesigs.clear();
+    AddTimeSig ( 0, 4, 4 );
+
+    // time signatures of all tracks in time order
+    std::vector<const MIDITimedBigMessage *> events;
+
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = 0; i < track->GetNumEvents(); ++i )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( msg->IsTimeSig() )
+                events.push_back ( msg );
+        }
+    }
+
+    std::stable_sort ( events.begin(), events.end(), [] ( const MIDITimedBigMessage * a, const MIDITimedBigMessage * b )
+    {
+        return a->GetTime() < b->GetTime();
+    } );
+
+    for ( size_t i = 0; i < events.size(); ++i )
+        AddTimeSig ( events[i]->GetTime(), events[i]->GetTimeSigNumerator(), events[i]->GetTimeSigDenominator() );
+
+    // every measure which starts up to the end of the music, and the end of the last one
+    MIDIClockTime end_clock = tempo_map->GetMusicEndClock();
+    MIDITempoMapCursor cursor ( tempo_map );
+
+    for ( int measure = 0; ; ++measure )
+    {
+        MIDIClockTime clock = ComputeMeasureStartClock ( measure );
+        measure_clock.push_back ( clock );
+        measure_ms.push_back ( cursor.ClockToMs ( clock ) );
+
+        if ( clock > end_clock || ( clock == end_clock && measure > 0 ) )
+            break;
+    }
+}
+
+void MIDIBeatGrid::AddTimeSig ( MIDIClockTime clock, int numerator, int denominator )
+{
+    TimeSig ts;
+    ts.clock = clock;
+    ts.first_measure = 0;
+    ts.numerator = numerator > 0 ? numerator : 4;
+    ts.denominator = denominator > 0 ? denominator : 4;
+    ts.beat_clocks = std::max ( 1, clks_per_beat * 4 / ts.denominator );
+    ts.measure_clocks = ts.beat_clocks * ts.numerator;
+
+    if ( !timesigs.empty() )
+    {
+        const TimeSig &last = timesigs.back();
+
+        // a later time signature at the same time replaces it
+        if ( clock <= last.clock )
+        {
+            ts.clock = last.clock;
+            ts.first_measure = last.first_measure;
+            timesigs.back() = ts;
+            return;
+        }
+
+        // the measure which is cut off by the new time signature is counted too
+        ts.first_measure = last.first_measure
+                           + ( int ) ( ( clock - last.clock + last.measure_clocks - 1 ) / last.measure_clocks );
+    }
+
+    timesigs.push_back ( ts );
+}
+
+int MIDIBeatGrid::GetMeasureAtClock ( MIDIClockTime clock ) const
+{
+    const TimeSig &ts = timesigs[FindTimeSigOfClock ( clock )];
+    return ts.first_measure + ( int ) ( ( clock - ts.clock ) / ts.measure_clocks );
+}
+
+int MIDIBeatGrid::GetMeasureAtMs ( double ms ) const
+{
+    if ( ms < 0.0 )
+        return 0;
+
+    if ( ms < measure_ms.back() || !tempo_map )
+    {
+        int measure = ( int ) ( std::upper_bound ( measure_ms.begin(), measure_ms.end(), ms ) - measure_ms.begin() ) - 1;
+        return measure > 0 ? measure : 0;
+    }
+
+    return GetMeasureAtClock ( tempo_map->MsToClock ( ms ) );
+}
+
+void MIDIBeatGrid::ClockToMeasureBeat ( MIDIClockTime clock, int *measure, int *beat, MIDIClockTime *beat_offset ) const
+{
+    const TimeSig &ts = timesigs[FindTimeSigOfClock ( clock )];
+    MIDIClockTime offset = ( clock - ts.clock ) % ts.measure_clocks;
+
+    *measure = ts.first_measure + ( int ) ( ( clock - ts.clock ) / ts.measure_clocks );
+    *beat = ( int ) ( offset / ts.beat_clocks );
+
+    if ( beat_offset )
+        *beat_offset = offset % ts.beat_clocks;
+}
+
+MIDIClockTime MIDIBeatGrid::MeasureBeatToClock ( int measure, int beat ) const
+{
+    return GetMeasureStartClock ( measure ) + ( MIDIClockTime ) beat * GetTimeSigOfMeasure ( measure ).beat_clocks;
+}
+
+int MIDIBeatGrid::FindTimeSigOfClock ( MIDIClockTime clock ) const
+{
+    int lo = 0;
+    int hi = ( int ) timesigs.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( timesigs[mid].clock <= clock )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+int MIDIBeatGrid::FindTimeSigOfMeasure ( int measure ) const
+{
+    int lo = 0;
+    int hi = ( int ) timesigs.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( timesigs[mid].first_measure <= measure )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+}
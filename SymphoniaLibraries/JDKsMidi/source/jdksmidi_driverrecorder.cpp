@@ -0,0 +1,222 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/driverrecorder.h"
+#include "jdksmidi/filereadblock.h"
+#include "jdksmidi/fileread.h"
+#include "jdksmidi/filereadmultitrack.h"
+#include "jdksmidi/manager.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace jdksmidi
+{
+
+MIDIDriverRecorder::MIDIDriverRecorder ( int queue_size, int ring_size )
+    : MIDIDriver ( queue_size ),
+      ring ( ring_size > 0 ? ring_size : 1 ),
+      first_entry ( 0 ),
+      num_entries ( 0 ),
+      num_dropped ( 0 ),
+      clock ( 0 ),
+      origin_ns ( 0 ),
+      last_sys_time ( 0 ),
+      tempo_map ( 0 ),
+      tempo_scale ( 1.0 ),
+      intended_offset_ns ( 0 )
+{
+}
+
+MIDIDriverRecorder::~MIDIDriverRecorder()
+{
+}
+
+void MIDIDriverRecorder::Reset()
+{
+    MIDIDriver::Reset();
+    ClearEntries();
+    last_sys_time = 0;
+}
+
+bool MIDIDriverRecorder::HardwareMsgOut ( const MIDITimedBigMessage &msg )
+{
+    int ring_size = ( int ) ring.size();
+    int i = first_entry + num_entries;
+
+    if ( i >= ring_size )
+        i -= ring_size;
+
+    if ( num_entries == ring_size )
+    {
+        // overwrite the oldest entry
+        if ( ++first_entry == ring_size )
+            first_entry = 0;
+
+        ++num_dropped;
+    }
+    else
+    {
+        ++num_entries;
+    }
+
+    MIDIDriverRecorderEntry &entry = ring[i];
+    entry.status = msg.GetStatus();
+    entry.byte1 = msg.GetByte1();
+    entry.byte2 = msg.GetByte2();
+    entry.clock = msg.GetTime();
+
+    if ( clock )
+        entry.actual_ns = clock->GetTimeNs() - origin_ns;
+    else
+        entry.actual_ns = ( int64_t ) last_sys_time * 1000000;
+
+    if ( tempo_map )
+        entry.intended_ns = intended_offset_ns + ( int64_t ) ( tempo_map->ClockToMs ( entry.clock ) * 1000000.0 / tempo_scale );
+    else
+        entry.intended_ns = 0;
+
+    return true;
+}
+
+void MIDIDriverRecorder::TimeTick ( unsigned long sys_time )
+{
+    last_sys_time = sys_time;
+    MIDIDriver::TimeTick ( sys_time );
+}
+
+bool MIDIDriverRecorder::GetStats ( MIDIDriverRecorderStats *stats ) const
+{
+    stats->num_messages = num_entries;
+    stats->num_dropped = num_dropped;
+    stats->min_lateness_ns = 0;
+    stats->p50_lateness_ns = 0;
+    stats->p99_lateness_ns = 0;
+    stats->max_lateness_ns = 0;
+    stats->mean_lateness_ns = 0.0;
+    stats->messages_per_second = 0.0;
+
+    if ( num_entries == 0 )
+        return false;
+
+    std::vector<int64_t> lateness ( num_entries );
+    double sum = 0.0;
+
+    for ( int n = 0; n < num_entries; ++n )
+    {
+        lateness[n] = GetEntry ( n ).GetLatenessNs();
+        sum += ( double ) lateness[n];
+    }
+
+    std::sort ( lateness.begin(), lateness.end() );
+
+    stats->min_lateness_ns = lateness.front();
+    stats->p50_lateness_ns = lateness[ ( num_entries - 1 ) / 2];
+    stats->p99_lateness_ns = lateness[ ( int ) ( ( num_entries - 1 ) * 0.99 )];
+    stats->max_lateness_ns = lateness.back();
+    stats->mean_lateness_ns = sum / num_entries;
+
+    int64_t span_ns = GetEntry ( num_entries - 1 ).actual_ns - GetEntry ( 0 ).actual_ns;
+
+    if ( span_ns > 0 )
+        stats->messages_per_second = num_entries * 1e9 / span_ns;
+
+    return true;
+}
+
+
+MIDIDriverRecorderBenchmark::MIDIDriverRecorderBenchmark ( MIDITimingClock *clock_, int64_t period_ns_, int ring_size_ )
+    : clock ( clock_ ),
+      period_ns ( period_ns_ ),
+      ring_size ( ring_size_ )
+{
+}
+
+MIDIDriverRecorderBenchmark::~MIDIDriverRecorderBenchmark()
+{
+}
+
+bool MIDIDriverRecorderBenchmark::Run ( const char *fname, MIDIDriverRecorderStats *stats )
+{
+    MIDIFileReadStreamBufferedFile stream ( fname );
+
+    if ( !stream.IsValid() )
+        return false;
+
+    MIDIMultiTrack tracks ( 64 );
+    MIDIFileReadMultiTrack track_loader ( &tracks );
+    MIDIFileReadBlock reader ( &stream, &track_loader );
+
+    if ( !reader.Parse() )
+        return false;
+
+    return Run ( &tracks, stats );
+}
+
+bool MIDIDriverRecorderBenchmark::Run ( const MIDIMultiTrack *tracks, MIDIDriverRecorderStats *stats )
+{
+    MIDITempoMap tempo_map;
+    tempo_map.Build ( tracks );
+
+    MIDISequencer seq ( tracks );
+    MIDIDriverRecorder driver ( 1024, ring_size );
+    MIDIManager manager ( &driver, 0, &seq );
+    MIDITimingEngine engine ( &driver, clock, period_ns );
+
+    driver.SetTickProc ( &manager );
+    driver.SetTempoMap ( &tempo_map );
+
+    seq.GoToZero();
+    manager.SetTimeOffset ( 0 );
+    manager.SetSeqOffset ( 0 );
+    manager.SeqPlay();
+
+    // a few periods more, for the last events to get out of the queue
+    int64_t duration_ns = ( int64_t ) ( tempo_map.GetMusicDurationInMilliseconds() * 1000000.0 ) + 4 * period_ns;
+
+    std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+    driver.SetTimeSource ( clock, clock->GetTimeNs() );
+    engine.Run ( duration_ns );
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_start;
+
+    manager.SeqStop();
+
+    bool ok = driver.GetStats ( stats );
+
+    if ( wall_time.count() > 0.0 )
+        stats->messages_per_second = stats->num_messages / wall_time.count();
+
+    return ok;
+}
+
+void MIDIDriverRecorderBenchmark::Print ( FILE *f, const char *name, const MIDIDriverRecorderStats &stats )
+{
+    fprintf ( f, "%s: %lu msgs (%lu dropped), lateness us p50 %.1f p99 %.1f max %.1f mean %.1f, %.0f msgs/s\n",
+              name,
+              stats.num_messages,
+              stats.num_dropped,
+              stats.p50_lateness_ns * 0.001,
+              stats.p99_lateness_ns * 0.001,
+              stats.max_lateness_ns * 0.001,
+              stats.mean_lateness_ns * 0.001,
+              stats.messages_per_second );
+}
+
+}
@@ -0,0 +1,266 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/edittrackindexed.h"
+
+#include <algorithm>
+
+namespace jdksmidi
+{
+
+MIDITrackTimeIndex::MIDITrackTimeIndex ( const MIDITrack *track_, int block_size_ )
+    : track ( track_ ),
+      block_size ( block_size_ > 0 ? block_size_ : 64 )
+{
+    Build();
+}
+
+MIDITrackTimeIndex::~MIDITrackTimeIndex()
+{
+}
+
+void MIDITrackTimeIndex::Update ( int event_num )
+{
+    int num_events = track ? track->GetNumEvents() : 0;
+    int num_blocks = ( num_events + block_size - 1 ) / block_size;
+    int first_block = std::min ( std::max ( event_num, 0 ) / block_size, ( int ) block_max.size() );
+
+    block_max.resize ( num_blocks );
+
+    MIDIClockTime max_time = ( first_block > 0 ) ? block_max[first_block - 1] : 0;
+
+    for ( int block = first_block; block < num_blocks; ++block )
+    {
+        int end = std::min ( ( block + 1 ) * block_size, num_events );
+
+        for ( int i = block * block_size; i < end; ++i )
+            max_time = std::max ( max_time, track->GetEventAddress ( i )->GetTime() );
+
+        block_max[block] = max_time;
+    }
+}
+
+int MIDITrackTimeIndex::FindFirstAtOrAfter ( MIDIClockTime time ) const
+{
+    int block = ( int ) ( std::lower_bound ( block_max.begin(), block_max.end(), time ) - block_max.begin() );
+    int num_events = track ? track->GetNumEvents() : 0;
+
+    if ( block >= ( int ) block_max.size() )
+        return num_events;
+
+    int end = std::min ( ( block + 1 ) * block_size, num_events );
+
+    for ( int i = block * block_size; i < end; ++i )
+    {
+        if ( track->GetEventAddress ( i )->GetTime() >= time )
+            return i;
+    }
+
+    return end;
+}
+
+
+MIDIEditTrackIndexed::MIDIEditTrackIndexed ( MIDITrack *track_, int block_size )
+    : track ( track_ ),
+      index ( track_, block_size ),
+      batch_level ( 0 )
+{
+}
+
+MIDIEditTrackIndexed::~MIDIEditTrackIndexed()
+{
+}
+
+void MIDIEditTrackIndexed::Process (
+    MIDIClockTime start_time,
+    MIDIClockTime end_time,
+    MIDIProcessor *process,
+    MIDIEditTrackEventMatcher *match
+)
+{
+    int num_events = track->GetNumEvents();
+
+    for ( int i = index.FindFirstAtOrAfter ( start_time ); i < num_events; ++i )
+    {
+        MIDITimedBigMessage *ev = track->GetEventAddress ( i );
+
+        if ( ev->GetTime() >= end_time )
+            break;
+
+        if ( ev->IsNoOp() || ( match && !match->Match ( *ev ) ) )
+            continue;
+
+        if ( !process->Process ( ev ) )
+            track->MakeEventNoOp ( i );
+    }
+}
+
+int MIDIEditTrackIndexed::Erase (
+    MIDIClockTime start,
+    MIDIClockTime end,
+    MIDIEditTrackEventMatcher *match
+)
+{
+    int num_events = track->GetNumEvents();
+    int num_erased = 0;
+
+    for ( int i = index.FindFirstAtOrAfter ( start ); i < num_events; ++i )
+    {
+        MIDITimedBigMessage *ev = track->GetEventAddress ( i );
+
+        if ( ev->GetTime() >= end )
+            break;
+
+        if ( ev->IsNoOp() || ( match && !match->Match ( *ev ) ) )
+            continue;
+
+        track->MakeEventNoOp ( i );
+        ++num_erased;
+    }
+
+    return num_erased;
+}
+
+void MIDIEditTrackIndexed::Delete (
+    MIDIClockTime start,
+    MIDIClockTime end
+)
+{
+    if ( end <= start )
+        return;
+
+    int first = index.FindFirstAtOrAfter ( start );
+    int last = index.FindFirstAtOrAfter ( end );
+
+    // the erased events stay at start, before the events which are moved back
+    for ( int i = first; i < last; ++i )
+    {
+        track->MakeEventNoOp ( i );
+        track->GetEventAddress ( i )->SetTime ( start );
+    }
+
+    ShiftFrom ( last, - ( signed long ) ( end - start ) );
+    index.Update ( first );
+}
+
+void MIDIEditTrackIndexed::Insert (
+    MIDIClockTime start,
+    MIDIClockTime length
+)
+{
+    int first = index.FindFirstAtOrAfter ( start );
+    ShiftFrom ( first, ( signed long ) length );
+    index.Update ( first );
+}
+
+void MIDIEditTrackIndexed::Shift (
+    signed long offset,
+    MIDIEditTrackEventMatcher *match
+)
+{
+    if ( match == 0 )
+    {
+        ShiftFrom ( 0, offset );
+        index.Build();
+        return;
+    }
+
+    // matched events are taken out and put back at their new time with the rebuild
+    int num_events = track->GetNumEvents();
+
+    for ( int i = 0; i < num_events; ++i )
+    {
+        MIDITimedBigMessage *ev = track->GetEventAddress ( i );
+
+        if ( ev->IsNoOp() || !match->Match ( *ev ) )
+            continue;
+
+        signed long time = ( signed long ) ev->GetTime() + offset;
+        pending.push_back ( std::move ( *ev ) );
+        pending.back().SetTime ( time > 0 ? ( MIDIClockTime ) time : 0 );
+        track->MakeEventNoOp ( i );
+    }
+
+    RebuildIfNotInBatch();
+}
+
+bool MIDIEditTrackIndexed::PutEvent ( const MIDITimedBigMessage &msg )
+{
+    pending.push_back ( msg );
+    return RebuildIfNotInBatch();
+}
+
+bool MIDIEditTrackIndexed::EndBatch()
+{
+    if ( batch_level > 0 && --batch_level > 0 )
+        return true;
+
+    return pending.empty() || Rebuild();
+}
+
+void MIDIEditTrackIndexed::ShiftFrom ( int event_num, signed long offset )
+{
+    int num_events = track->GetNumEvents();
+
+    for ( int i = event_num; i < num_events; ++i )
+    {
+        MIDITimedBigMessage *ev = track->GetEventAddress ( i );
+        signed long time = ( signed long ) ev->GetTime() + offset;
+        ev->SetTime ( time > 0 ? ( MIDIClockTime ) time : 0 );
+    }
+}
+
+bool MIDIEditTrackIndexed::Rebuild()
+{
+    std::stable_sort ( pending.begin(), pending.end(),
+                       [] ( const MIDITimedBigMessage & a, const MIDITimedBigMessage & b )
+    {
+        return a.GetTime() < b.GetTime();
+    } );
+
+    int num_events = track->GetNumEvents();
+    MIDITrack rebuilt ( num_events + ( int ) pending.size() );
+    bool ok = true;
+    size_t p = 0;
+
+    // merge, pending events go after track events of the same time
+    for ( int i = 0; i < num_events; ++i )
+    {
+        MIDITimedBigMessage *ev = track->GetEventAddress ( i );
+
+        if ( ev->IsNoOp() )
+            continue;
+
+        while ( p < pending.size() && pending[p].GetTime() < ev->GetTime() )
+            ok = rebuilt.PutEvent ( std::move ( pending[p++] ) ) && ok;
+
+        ok = rebuilt.PutEvent ( std::move ( *ev ) ) && ok;
+    }
+
+    while ( p < pending.size() )
+        ok = rebuilt.PutEvent ( std::move ( pending[p++] ) ) && ok;
+
+    pending.clear();
+    *track = std::move ( rebuilt );
+    index.Build();
+    return ok;
+}
+
+}
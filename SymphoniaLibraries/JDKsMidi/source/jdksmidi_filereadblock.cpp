@@ -0,0 +1,319 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/filereadblock.h"
+
+namespace jdksmidi
+{
+
+MIDIFileReadStreamBufferedFile::MIDIFileReadStreamBufferedFile ( const char *fname )
+{
+    FILE *f = fopen ( fname, "rb" );
+
+    if ( f )
+    {
+        Load ( f );
+        fclose ( f );
+    }
+}
+
+#ifdef WIN32
+MIDIFileReadStreamBufferedFile::MIDIFileReadStreamBufferedFile ( const wchar_t *fname )
+{
+    FILE *f = _wfopen ( fname, L"rb" );
+
+    if ( f )
+    {
+        Load ( f );
+        fclose ( f );
+    }
+}
+#endif
+
+MIDIFileReadStreamBufferedFile::MIDIFileReadStreamBufferedFile ( FILE *f_ )
+{
+    Load ( f_ );
+}
+
+MIDIFileReadStreamBufferedFile::~MIDIFileReadStreamBufferedFile()
+{
+}
+
+bool MIDIFileReadStreamBufferedFile::Load ( FILE *f )
+{
+    data.clear();
+
+    if ( !f )
+        return false;
+
+    // files are read with one fread(), streams without known size (pipes) in blocks
+    long start = ftell ( f );
+    long size = -1;
+
+    if ( start >= 0 && fseek ( f, 0, SEEK_END ) == 0 )
+    {
+        size = ftell ( f ) - start;
+        fseek ( f, start, SEEK_SET );
+    }
+
+    if ( size >= 0 )
+    {
+        data.resize ( size );
+
+        if ( size > 0 && fread ( &data[0], 1, size, f ) != ( size_t ) size )
+            data.clear();
+    }
+    else
+    {
+        const size_t block_size = 65536;
+        size_t got = 0;
+
+        do
+        {
+            data.resize ( got + block_size );
+            got += fread ( &data[got], 1, block_size, f );
+        }
+        while ( got == data.size() );
+
+        data.resize ( got );
+    }
+
+    if ( ferror ( f ) )
+        data.clear();
+
+    if ( data.empty() )
+        return false;
+
+    SetBuffer ( &data[0], ( unsigned long ) data.size() );
+    return true;
+}
+
+
+MIDIFileReadBlock::MIDIFileReadBlock (
+    MIDIFileReadStreamBlock *input_stream_,
+    MIDIFileEvents *event_handler_,
+    unsigned long max_msg_len
+)
+    : MIDIFileRead ( input_stream_, event_handler_, max_msg_len ),
+      block_stream ( input_stream_ ),
+      block_event_handler ( event_handler_ ),
+      block_used_running_status ( false )
+{
+}
+
+MIDIFileReadBlock::~MIDIFileReadBlock()
+{
+}
+
+bool MIDIFileReadBlock::Parse()
+{
+    block_used_running_status = false;
+    abort_parse = 0;
+
+    if ( ReadHeader() <= 0 )
+    {
+        mf_error ( "No header chunk" );
+        return false;
+    }
+
+    bool ok = true;
+    int num_tracks = GetNumTracks();
+    int trk = 0;
+
+    for ( ; trk < num_tracks && !abort_parse; ++trk )
+    {
+        unsigned long len = 0;
+        const unsigned char *data = ReadTrackChunk ( &len );
+
+        if ( !data )
+            break;
+
+        if ( !ReadTrackBlock ( trk, data, len ) )
+            ok = false;
+    }
+
+    block_event_handler->SortEventsOrder();
+
+    return ok && trk == num_tracks;
+}
+
+const unsigned char *MIDIFileReadBlock::ReadTrackChunk ( unsigned long *len )
+{
+    for ( ;; )
+    {
+        const unsigned char *chunk_header = block_stream->ReadBlock ( 8 );
+
+        if ( !chunk_header )
+            return 0;
+
+        unsigned long id = To32Bit ( chunk_header[0], chunk_header[1], chunk_header[2], chunk_header[3] );
+        unsigned long chunk_len = To32Bit ( chunk_header[4], chunk_header[5], chunk_header[6], chunk_header[7] );
+        const unsigned char *body = block_stream->ReadBlock ( chunk_len );
+
+        if ( !body )
+        {
+            mf_error ( "Unexpected end of file" );
+            return 0;
+        }
+
+        // skip unknown chunks
+        if ( id == _MTrk )
+        {
+            *len = chunk_len;
+            return body;
+        }
+    }
+}
+
+bool MIDIFileReadBlock::ReadBlockVariableNum ( const unsigned char **p, const unsigned char *end, unsigned long *num )
+{
+    unsigned long value = 0;
+
+    for ( int i = 0; i < 4; ++i )
+    {
+        if ( *p >= end )
+            return false;
+
+        unsigned char c = * ( *p ) ++;
+        value = ( value << 7 ) | ( c & 0x7f );
+
+        if ( ( c & 0x80 ) == 0 )
+        {
+            *num = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MIDIFileReadBlock::ReadTrackBlock ( int trk, const unsigned char *data, unsigned long len )
+{
+    const unsigned char *p = data;
+    const unsigned char *end = data + len;
+    unsigned char status = 0;
+    bool ok = true;
+
+    MIDITimedMessage msg;
+
+    cur_track = trk;
+    cur_time = 0;
+    block_event_handler->mf_starttrack ( trk );
+
+    while ( p < end && !abort_parse )
+    {
+        unsigned long delta_time;
+
+        if ( !ReadBlockVariableNum ( &p, end, &delta_time ) || p >= end )
+        {
+            mf_error ( "Unexpected end of track" );
+            break;
+        }
+
+        block_event_handler->UpdateTime ( delta_time );
+        cur_time += delta_time;
+
+        unsigned char c = *p++;
+
+        if ( c < 0x80 )
+        {
+            // running status, c is the first data byte
+            if ( status == 0 )
+            {
+                mf_error ( "Unexpected running status" );
+                break;
+            }
+
+            block_used_running_status = true;
+            --p;
+        }
+        else if ( c < SYSEX_START_N )
+        {
+            status = c;
+        }
+        else if ( c == META_EVENT || c == SYSEX_START_N || c == SYSEX_START_A )
+        {
+            int type = 0;
+
+            if ( c == META_EVENT )
+            {
+                if ( p >= end )
+                {
+                    mf_error ( "Unexpected end of track" );
+                    break;
+                }
+
+                type = *p++;
+            }
+
+            unsigned long data_len;
+
+            if ( !ReadBlockVariableNum ( &p, end, &data_len ) || data_len > ( unsigned long ) ( end - p ) )
+            {
+                mf_error ( "Unexpected end of track" );
+                break;
+            }
+
+            // the data is given straight from the block, handlers only read it
+            unsigned char *event_data = const_cast<unsigned char *> ( p );
+            p += data_len;
+
+            if ( c == META_EVENT )
+            {
+                if ( !block_event_handler->MetaEvent ( cur_time, type, ( int ) data_len, event_data ) )
+                    ok = false;
+            }
+            else
+            {
+                if ( !block_event_handler->mf_sysex ( cur_time, c, ( int ) data_len, event_data ) )
+                    ok = false;
+            }
+
+            continue;
+        }
+        else
+        {
+            mf_error ( "Unexpected byte in track" );
+            break;
+        }
+
+        int num_data_bytes = GetMessageLength ( status ) - 1;
+
+        if ( end - p < num_data_bytes )
+        {
+            mf_error ( "Unexpected end of track" );
+            break;
+        }
+
+        msg.SetStatus ( status );
+        msg.SetByte1 ( *p++ );
+        msg.SetByte2 ( ( num_data_bytes > 1 ) ? *p++ : 0 );
+        msg.SetTime ( cur_time );
+
+        if ( !block_event_handler->ChanMessage ( msg ) )
+            ok = false;
+    }
+
+    block_event_handler->mf_endtrack ( trk );
+
+    return ok;
+}
+
+}
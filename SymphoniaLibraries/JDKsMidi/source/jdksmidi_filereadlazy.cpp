@@ -0,0 +1,276 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/filereadlazy.h"
+
+namespace jdksmidi
+{
+
+// track_loader is only stored by the base class before it is constructed
+MIDIFileReadLazy::MIDIFileReadLazy (
+    MIDIFileReadStreamBlock *input_stream_,
+    MIDIMultiTrack *multitrack_,
+    unsigned long max_msg_len
+)
+    : MIDIFileReadBlock ( input_stream_, &track_loader, max_msg_len ),
+      track_loader ( multitrack_ ),
+      multitrack ( multitrack_ ),
+      timesig_numerator ( 4 ),
+      timesig_denominator ( 4 ),
+      timesig_found ( false ),
+      music_end_clock ( 0 )
+{
+}
+
+MIDIFileReadLazy::~MIDIFileReadLazy()
+{
+}
+
+bool MIDIFileReadLazy::Index()
+{
+    chunk_info.clear();
+    tempo_changes.clear();
+    timesig_numerator = 4;
+    timesig_denominator = 4;
+    timesig_found = false;
+    music_end_clock = 0;
+    abort_parse = 0;
+
+    block_stream->Rewind();
+
+    if ( ReadHeader() <= 0 )
+    {
+        mf_error ( "No header chunk" );
+        return false;
+    }
+
+    int num_tracks = GetNumTracks();
+
+    // events of an earlier song must not stay in the multitrack. a format 0 chunk is split
+    // over 17 tracks, track 0 and one for every channel
+    if ( !multitrack->ClearAndResize ( GetFormat() == 0 ? 17 : num_tracks ) )
+    {
+        mf_error ( "Not enough memory for the tracks" );
+        return false;
+    }
+
+    chunk_info.reserve ( num_tracks );
+
+    for ( int trk = 0; trk < num_tracks; ++trk )
+    {
+        ChunkInfo info;
+        info.data = ReadTrackChunk ( &info.len );
+        info.end_clock = 0;
+        info.decoded = false;
+
+        if ( !info.data )
+            break;
+
+        // the tempo changes are those of the conductor track, as for MIDITempoMap
+        if ( !ScanChunk ( &info, trk == 0 ) )
+            mf_error ( "Unexpected end of track" );
+
+        if ( info.end_clock > music_end_clock )
+            music_end_clock = info.end_clock;
+
+        chunk_info.push_back ( info );
+    }
+
+    return ( int ) chunk_info.size() == num_tracks;
+}
+
+bool MIDIFileReadLazy::Parse()
+{
+    return Index() && DecodeAllTracks();
+}
+
+MIDITrack *MIDIFileReadLazy::GetTrack ( int trk )
+{
+    if ( trk < 0 || trk >= multitrack->GetNumTracks() )
+        return 0;
+
+    DecodeTrack ( trk );
+    return multitrack->GetTrack ( trk );
+}
+
+bool MIDIFileReadLazy::DecodeTrack ( int trk )
+{
+    int chunk = GetChunkOfTrack ( trk );
+
+    if ( chunk < 0 )
+        return false;
+
+    ChunkInfo &info = chunk_info[chunk];
+
+    if ( info.decoded )
+        return true;
+
+    info.decoded = true;
+    abort_parse = 0;
+
+    bool ok = ReadTrackBlock ( chunk, info.data, info.len );
+
+    // a format 0 chunk is split over all tracks
+    if ( GetFormat() == 0 )
+        multitrack->SortEventsOrder();
+    else
+        multitrack->GetTrack ( trk )->SortEventsOrder();
+
+    return ok;
+}
+
+bool MIDIFileReadLazy::DecodeAllTracks()
+{
+    bool ok = true;
+
+    for ( int chunk = 0; chunk < ( int ) chunk_info.size(); ++chunk )
+    {
+        if ( !DecodeTrack ( chunk ) )
+            ok = false;
+    }
+
+    return ok;
+}
+
+double MIDIFileReadLazy::GetStartTempoBPM() const
+{
+    unsigned long us_per_quarter = 500000;
+
+    if ( !tempo_changes.empty() && tempo_changes[0].clock == 0 )
+        us_per_quarter = tempo_changes[0].us_per_quarter;
+
+    return 60000000.0 / us_per_quarter;
+}
+
+double MIDIFileReadLazy::GetMusicDurationInMilliseconds() const
+{
+    int division = GetDivision();
+
+    if ( division <= 0 )
+        return 0.0;
+
+    double ms = 0.0;
+    MIDIClockTime clock = 0;
+    unsigned long us_per_quarter = 500000;
+
+    for ( size_t i = 0; i < tempo_changes.size() && tempo_changes[i].clock < music_end_clock; ++i )
+    {
+        ms += ( tempo_changes[i].clock - clock ) * ( us_per_quarter * 0.001 / division );
+        clock = tempo_changes[i].clock;
+        us_per_quarter = tempo_changes[i].us_per_quarter;
+    }
+
+    return ms + ( music_end_clock - clock ) * ( us_per_quarter * 0.001 / division );
+}
+
+bool MIDIFileReadLazy::ScanChunk ( ChunkInfo *info, bool conductor )
+{
+    const unsigned char *p = info->data;
+    const unsigned char *end = info->data + info->len;
+    unsigned char status = 0;
+    MIDIClockTime time = 0;
+
+    while ( p < end )
+    {
+        unsigned long delta_time;
+
+        if ( !ReadBlockVariableNum ( &p, end, &delta_time ) || p >= end )
+            return false;
+
+        time += delta_time;
+        unsigned char c = *p;
+
+        if ( c == META_EVENT || c == SYSEX_START_N || c == SYSEX_START_A )
+        {
+            ++p;
+            int type = 0;
+
+            if ( c == META_EVENT )
+            {
+                if ( p >= end )
+                    return false;
+
+                type = *p++;
+            }
+
+            unsigned long len;
+
+            if ( !ReadBlockVariableNum ( &p, end, &len ) || len > ( unsigned long ) ( end - p ) )
+                return false;
+
+            if ( c == META_EVENT )
+            {
+                if ( type == META_END_OF_TRACK )
+                    return true;
+
+                if ( type == META_TRACK_NAME && info->name.empty() )
+                {
+                    info->name.assign ( ( const char * ) p, len );
+                }
+                else if ( type == META_TEMPO && len == 3 && conductor )
+                {
+                    TempoChange tempo;
+                    tempo.clock = time;
+                    tempo.us_per_quarter = ( ( unsigned long ) p[0] << 16 ) | ( ( unsigned long ) p[1] << 8 ) | p[2];
+
+                    if ( tempo.us_per_quarter > 0 )
+                        tempo_changes.push_back ( tempo );
+                }
+                else if ( type == META_TIMESIG && len >= 2 && time == 0 && p[1] < 8 && !timesig_found )
+                {
+                    timesig_found = true;
+                    timesig_numerator = p[0];
+                    timesig_denominator = 1 << p[1];
+                }
+            }
+
+            p += len;
+        }
+        else
+        {
+            // channel message, only skipped
+            if ( c >= 0x80 )
+            {
+                if ( c >= SYSEX_START_N )
+                    return false;
+
+                status = c;
+                ++p;
+            }
+            else if ( status == 0 )
+            {
+                return false;
+            }
+
+            int num_data_bytes = GetMessageLength ( status ) - 1;
+
+            if ( end - p < num_data_bytes )
+                return false;
+
+            p += num_data_bytes;
+        }
+
+        info->end_clock = time;
+    }
+
+    return true;
+}
+
+}
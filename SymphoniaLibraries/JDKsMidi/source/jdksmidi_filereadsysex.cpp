@@ -0,0 +1,176 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/filereadsysex.h"
+
+#include <stdint.h>
+
+namespace jdksmidi
+{
+
+MIDIFileReadMultiTrackSysEx::MIDIFileReadMultiTrackSysEx ( MIDIMultiTrack *mlttrk, SysExMode mode_, MIDISysExPool *pool_ )
+    : MIDIFileReadMultiTrack ( mlttrk ),
+      mode ( mode_ ),
+      source_buf ( 0 ),
+      source_len ( 0 ),
+      pool ( pool_ ),
+      num_skipped ( 0 ),
+      num_referenced ( 0 ),
+      num_interned ( 0 )
+{
+}
+
+MIDIFileReadMultiTrackSysEx::~MIDIFileReadMultiTrackSysEx()
+{
+}
+
+bool MIDIFileReadMultiTrackSysEx::mf_sysex ( MIDIClockTime time, int type, int len, unsigned char *s )
+{
+    switch ( mode )
+    {
+    case SYSEX_SKIP:
+        ++num_skipped;
+        return true;
+
+    case SYSEX_REFERENCE:
+    {
+        // s may point into another buffer, so the addresses are compared as integers
+        uintptr_t addr = ( uintptr_t ) s;
+        uintptr_t base = ( uintptr_t ) source_buf;
+
+        if ( len <= MAX_REF_LENGTH && source_buf && addr >= base
+                && addr - base <= source_len && ( unsigned long ) len <= source_len - ( addr - base )
+                && addr - base <= 0xffffffffUL )
+        {
+            ++num_referenced;
+            return AddSysExRef ( time, type, ( unsigned long ) ( addr - base ), len, false );
+        }
+    }
+
+        // not in the source, interned instead
+        // fall through
+
+    case SYSEX_INTERN:
+        if ( pool && len <= MAX_REF_LENGTH )
+        {
+            ++num_interned;
+            return AddSysExRef ( time, type, ( unsigned long ) pool->Intern ( s, len ), len, true );
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    return MIDIFileReadMultiTrack::mf_sysex ( time, type, len, s );
+}
+
+bool MIDIFileReadMultiTrackSysEx::AddSysExRef ( MIDIClockTime time, int type, unsigned long ref_num, int len, bool interned )
+{
+    // a NoOp, so a reference can not be written or sent as a sysex without data
+    MIDITimedMessage msg;
+    msg.SetNoOp();
+    msg.SetTime ( time );
+    msg.SetDataLength ( ( unsigned char ) type );
+    msg.SetByte1 ( ( unsigned char ) ( ref_num & 0xff ) );
+    msg.SetByte2 ( ( unsigned char ) ( ( ref_num >> 8 ) & 0xff ) );
+    msg.SetByte3 ( ( unsigned char ) ( ( ref_num >> 16 ) & 0xff ) );
+    msg.SetByte4 ( ( unsigned char ) ( ( ref_num >> 24 ) & 0xff ) );
+    msg.SetByte5 ( ( unsigned char ) ( len & 0xff ) );
+    msg.SetByte6 ( ( unsigned char ) ( ( ( len >> 8 ) & 0x7f ) | ( interned ? 0x80 : 0 ) ) );
+
+    return AddEventToMultiTrack ( msg, 0, cur_track );
+}
+
+const unsigned char *MIDIFileReadMultiTrackSysEx::GetSysExData ( const MIDITimedBigMessage &msg, int *len ) const
+{
+    *len = 0;
+
+    if ( msg.IsSysExN() || msg.IsSysExA() )
+    {
+        const MIDISystemExclusive *sysex = msg.GetSysEx();
+
+        if ( !sysex )
+            return 0;
+
+        *len = sysex->GetLengthSE();
+        return sysex->GetBuf();
+    }
+
+    if ( !IsSysExRef ( msg ) )
+        return 0;
+
+    unsigned long ref_num = GetSysExRefNumber ( msg );
+
+    if ( IsSysExRefInterned ( msg ) )
+    {
+        if ( !pool || ( long ) ref_num >= pool->GetNumBlobs() )
+            return 0;
+
+        *len = pool->GetLength ( ( long ) ref_num );
+        return pool->GetData ( ( long ) ref_num );
+    }
+
+    int ref_len = GetSysExRefLength ( msg );
+
+    if ( !source_buf || ref_num + ref_len > source_len )
+        return 0;
+
+    *len = ref_len;
+    return source_buf + ref_num;
+}
+
+int MIDIFileReadMultiTrackSysEx::ResolveSysEx ( MIDIMultiTrack *multitrack ) const
+{
+    int num_resolved = 0;
+
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = 0; i < track->GetNumEvents(); ++i )
+        {
+            MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( !IsSysExRef ( *msg ) )
+                continue;
+
+            int len;
+            const unsigned char *data = GetSysExData ( *msg, &len );
+
+            // a reference to data which is gone stays a NoOp
+            if ( !data )
+                continue;
+
+            MIDISystemExclusive sysex ( const_cast<unsigned char *> ( data ), len, len, false );
+            MIDITimedMessage resolved;
+            resolved.SetSysEx ( GetSysExRefType ( *msg ) );
+            resolved.SetTime ( msg->GetTime() );
+
+            *msg = MIDITimedBigMessage ( resolved, &sysex );
+            ++num_resolved;
+        }
+    }
+
+    return num_resolved;
+}
+
+}
@@ -0,0 +1,448 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/filewritebuffered.h"
+
+#include <atomic>
+#include <thread>
+
+namespace jdksmidi
+{
+
+MIDIFileWriteStreamMemory::MIDIFileWriteStreamMemory()
+    : pos ( 0 )
+{
+}
+
+MIDIFileWriteStreamMemory::~MIDIFileWriteStreamMemory()
+{
+}
+
+long MIDIFileWriteStreamMemory::Seek ( long offset, int whence )
+{
+    long new_pos;
+
+    switch ( whence )
+    {
+    case SEEK_SET:
+        new_pos = offset;
+        break;
+    case SEEK_CUR:
+        new_pos = ( long ) pos + offset;
+        break;
+    case SEEK_END:
+        new_pos = ( long ) data.size() + offset;
+        break;
+    default:
+        return -1;
+    }
+
+    if ( new_pos < 0 || new_pos > ( long ) data.size() )
+        return -1;
+
+    pos = ( unsigned long ) new_pos;
+    return 0;
+}
+
+int MIDIFileWriteStreamMemory::WriteChar ( int c )
+{
+    if ( pos == data.size() )
+        data.push_back ( ( unsigned char ) c );
+    else
+        data[pos] = ( unsigned char ) c;
+
+    ++pos;
+    return 0;
+}
+
+bool MIDIFileWriteStreamMemory::WriteBlock ( const unsigned char *buf, unsigned long len )
+{
+    if ( len == 0 )
+        return true;
+
+    if ( pos + len > data.size() )
+        data.resize ( pos + len );
+
+    memcpy ( &data[pos], buf, len );
+    pos += len;
+    return true;
+}
+
+bool MIDIFileWriteStreamMemory::SaveToFile ( const char *fname ) const
+{
+    FILE *f = fopen ( fname, "wb" );
+
+    if ( !f )
+        return false;
+
+    bool ok = data.empty() || fwrite ( &data[0], 1, data.size(), f ) == data.size();
+
+    if ( fclose ( f ) != 0 )
+        ok = false;
+
+    return ok;
+}
+
+
+MIDIFileWriteStreamBlockFile::MIDIFileWriteStreamBlockFile ( FILE *f_ )
+    : f ( f_ ), close_file ( false )
+{
+}
+
+MIDIFileWriteStreamBlockFile::MIDIFileWriteStreamBlockFile ( const char *fname )
+    : f ( fopen ( fname, "wb" ) ), close_file ( true )
+{
+}
+
+#ifdef WIN32
+MIDIFileWriteStreamBlockFile::MIDIFileWriteStreamBlockFile ( const wchar_t *fname )
+    : f ( _wfopen ( fname, L"wb" ) ), close_file ( true )
+{
+}
+#endif
+
+MIDIFileWriteStreamBlockFile::~MIDIFileWriteStreamBlockFile()
+{
+    if ( f && close_file )
+        fclose ( f );
+}
+
+long MIDIFileWriteStreamBlockFile::Seek ( long pos, int whence )
+{
+    return f ? fseek ( f, pos, whence ) : -1;
+}
+
+int MIDIFileWriteStreamBlockFile::WriteChar ( int c )
+{
+    if ( !f || fputc ( c, f ) == EOF )
+        return -1;
+
+    return 0;
+}
+
+bool MIDIFileWriteStreamBlockFile::WriteBlock ( const unsigned char *buf, unsigned long len )
+{
+    if ( !f )
+        return false;
+
+    return len == 0 || fwrite ( buf, 1, len, f ) == len;
+}
+
+
+MIDIFileTrackEncoder::MIDIFileTrackEncoder()
+    : use_running_status ( true ),
+      within_track ( true ),
+      track_time ( 0 ),
+      running_status ( 0 )
+{
+}
+
+MIDIFileTrackEncoder::~MIDIFileTrackEncoder()
+{
+}
+
+void MIDIFileTrackEncoder::Reset()
+{
+    buf.clear();
+    within_track = true;
+    track_time = 0;
+    running_status = 0;
+}
+
+void MIDIFileTrackEncoder::EncodeTrack ( const MIDITrack *track )
+{
+    Reset();
+
+    if ( track )
+    {
+        // 3 bytes per event is a good guess for the usual channel messages
+        buf.reserve ( track->GetNumEvents() * 3 + 4 );
+
+        for ( int event_num = 0; event_num < track->GetNumEvents(); ++event_num )
+        {
+            const MIDITimedBigMessage *ev = track->GetEventAddress ( event_num );
+            WriteEvent ( *ev );
+
+            if ( ev->IsDataEnd() )
+                break;
+        }
+    }
+
+    WriteEndOfTrack ( 0 );
+}
+
+void MIDIFileTrackEncoder::WriteEvent ( const MIDITimedBigMessage &m )
+{
+    if ( m.IsServiceMsg() || !within_track )
+        return;
+
+    MIDIClockTime time = m.GetTime();
+
+    if ( m.IsMetaEvent() )
+    {
+        // if the meta event has a sysex buffer attached, it contains the raw meta data
+        const MIDISystemExclusive *sysex = m.GetSysEx();
+
+        if ( sysex )
+        {
+            WriteMetaEvent ( time, m.GetMetaType(), sysex->GetBuf(), sysex->GetLengthSE() );
+            return;
+        }
+
+        unsigned char data[5];
+
+        switch ( m.GetMetaType() )
+        {
+        case META_END_OF_TRACK:
+            WriteEndOfTrack ( time );
+            break;
+
+        case META_TEMPO:
+        {
+            unsigned long tempo = m.GetTempo();
+            data[0] = ( unsigned char ) ( ( tempo >> 16 ) & 0xff );
+            data[1] = ( unsigned char ) ( ( tempo >> 8 ) & 0xff );
+            data[2] = ( unsigned char ) ( tempo & 0xff );
+            WriteMetaEvent ( time, META_TEMPO, data, 3 );
+            break;
+        }
+
+        case META_TIMESIG:
+            data[0] = m.GetTimeSigNumerator();
+            data[1] = m.GetTimeSigDenominatorPower();
+            // metronome clocks and 32nds per quarter, as SetTimeSig() stores them
+            data[2] = m.GetByte5();
+            data[3] = m.GetByte6();
+            WriteMetaEvent ( time, META_TIMESIG, data, 4 );
+            break;
+
+        case META_KEYSIG:
+            data[0] = ( unsigned char ) m.GetKeySigSharpFlats();
+            data[1] = m.GetKeySigMajorMinor();
+            WriteMetaEvent ( time, META_KEYSIG, data, 2 );
+            break;
+
+        default:
+            // other short meta events keep their data bytes in byte2...byte6
+            data[0] = m.GetByte2();
+            data[1] = m.GetByte3();
+            data[2] = m.GetByte4();
+            data[3] = m.GetByte5();
+            data[4] = m.GetByte6();
+            WriteMetaEvent ( time, m.GetMetaType(), data, m.GetDataLength() <= 5 ? m.GetDataLength() : 5 );
+            break;
+        }
+    }
+    else if ( m.IsSystemExclusive() )
+    {
+        const MIDISystemExclusive *sysex = m.GetSysEx();
+
+        if ( sysex )
+            WriteSystemExclusiveEvent ( time, m.GetStatus(), sysex->GetBuf(), sysex->GetLengthSE() );
+    }
+    else if ( m.IsChannelMsg() )
+    {
+        int len = m.GetLength();
+
+        WriteDeltaTime ( time );
+
+        if ( !use_running_status || m.GetStatus() != running_status )
+        {
+            running_status = m.GetStatus();
+            WriteCharacter ( running_status );
+        }
+
+        if ( len > 1 )
+            WriteCharacter ( m.GetByte1() );
+
+        if ( len > 2 )
+            WriteCharacter ( m.GetByte2() );
+    }
+
+    // other system messages (MTC, song position etc.) are not stored in midi files
+}
+
+void MIDIFileTrackEncoder::WriteMetaEvent ( MIDIClockTime time, unsigned char type, const unsigned char *data, unsigned long length )
+{
+    if ( !within_track )
+        return;
+
+    WriteDeltaTime ( time );
+    WriteCharacter ( META_EVENT );
+    WriteCharacter ( type );
+    WriteVariableNum ( length );
+    buf.insert ( buf.end(), data, data + length );
+
+    // meta and sysex events cancel running status
+    running_status = 0;
+
+    if ( type == META_END_OF_TRACK )
+        within_track = false;
+}
+
+void MIDIFileTrackEncoder::WriteSystemExclusiveEvent ( MIDIClockTime time, unsigned char type, const unsigned char *data, unsigned long length )
+{
+    if ( !within_track )
+        return;
+
+    WriteDeltaTime ( time );
+    WriteCharacter ( type );
+    WriteVariableNum ( length );
+    buf.insert ( buf.end(), data, data + length );
+
+    running_status = 0;
+}
+
+void MIDIFileTrackEncoder::WriteEndOfTrack ( MIDIClockTime time )
+{
+    WriteMetaEvent ( time, META_END_OF_TRACK, 0, 0 );
+}
+
+void MIDIFileTrackEncoder::WriteDeltaTime ( MIDIClockTime time )
+{
+    // events out of order are written at the time of the previous event
+    MIDIClockTime delta_time = 0;
+
+    if ( time > track_time )
+    {
+        delta_time = time - track_time;
+        track_time = time;
+    }
+
+    WriteVariableNum ( delta_time );
+}
+
+void MIDIFileTrackEncoder::WriteVariableNum ( unsigned long n )
+{
+    unsigned char bytes[5];
+    int num_bytes = 0;
+
+    bytes[num_bytes++] = ( unsigned char ) ( n & 0x7f );
+
+    while ( ( n >>= 7 ) != 0 )
+        bytes[num_bytes++] = ( unsigned char ) ( ( n & 0x7f ) | 0x80 );
+
+    while ( num_bytes > 0 )
+        WriteCharacter ( bytes[--num_bytes] );
+}
+
+
+MIDIFileWriteMultiTrackBuffered::MIDIFileWriteMultiTrackBuffered (
+    const MIDIMultiTrack *mlt_,
+    MIDIFileWriteStreamBlock *strm_
+)
+    : multitrack ( mlt_ ),
+      out_stream ( strm_ ),
+      use_running_status ( true ),
+      num_threads ( 0 )
+{
+}
+
+MIDIFileWriteMultiTrackBuffered::~MIDIFileWriteMultiTrackBuffered()
+{
+}
+
+void MIDIFileWriteMultiTrackBuffered::EncodeTracks ( int num_tracks )
+{
+    encoders.resize ( num_tracks );
+
+    for ( int i = 0; i < num_tracks; ++i )
+        encoders[i].UseRunningStatus ( use_running_status );
+
+    int threads = num_threads;
+
+    if ( threads <= 0 )
+        threads = ( int ) std::thread::hardware_concurrency();
+
+    if ( threads > num_tracks )
+        threads = num_tracks;
+
+    // every worker takes the next not encoded track until all are done. each track
+    // goes to its own encoder, so the tracks are only read and nothing is shared
+    std::atomic<int> next_track ( 0 );
+
+    auto encode = [&]()
+    {
+        for ( int i = next_track++; i < num_tracks; i = next_track++ )
+            encoders[i].EncodeTrack ( multitrack->GetTrack ( i ) );
+    };
+
+    std::vector<std::thread> workers;
+
+    for ( int i = 1; i < threads; ++i )
+        workers.push_back ( std::thread ( encode ) );
+
+    encode();
+
+    for ( size_t i = 0; i < workers.size(); ++i )
+        workers[i].join();
+}
+
+bool MIDIFileWriteMultiTrackBuffered::Write ( int num_tracks, int division )
+{
+    if ( num_tracks > multitrack->GetNumTracks() )
+        return false;
+
+    // first pass: encode all tracks, after that all chunk lengths are known
+    EncodeTracks ( num_tracks );
+
+    // second pass: write the file forward only
+    unsigned char header[14];
+    unsigned long header_len = 0;
+
+    header[header_len++] = 'M';
+    header[header_len++] = 'T';
+    header[header_len++] = 'h';
+    header[header_len++] = 'd';
+    header[header_len++] = 0;
+    header[header_len++] = 0;
+    header[header_len++] = 0;
+    header[header_len++] = 6;
+    header[header_len++] = 0;
+    header[header_len++] = ( unsigned char ) ( ( num_tracks > 1 ) ? 1 : 0 );
+    header[header_len++] = ( unsigned char ) ( ( num_tracks >> 8 ) & 0xff );
+    header[header_len++] = ( unsigned char ) ( num_tracks & 0xff );
+    header[header_len++] = ( unsigned char ) ( ( division >> 8 ) & 0xff );
+    header[header_len++] = ( unsigned char ) ( division & 0xff );
+
+    if ( !out_stream->WriteBlock ( header, header_len ) )
+        return false;
+
+    for ( int i = 0; i < num_tracks; ++i )
+    {
+        unsigned long len = encoders[i].GetLength();
+
+        header[0] = 'M';
+        header[1] = 'T';
+        header[2] = 'r';
+        header[3] = 'k';
+        header[4] = ( unsigned char ) ( ( len >> 24 ) & 0xff );
+        header[5] = ( unsigned char ) ( ( len >> 16 ) & 0xff );
+        header[6] = ( unsigned char ) ( ( len >> 8 ) & 0xff );
+        header[7] = ( unsigned char ) ( len & 0xff );
+
+        if ( !out_stream->WriteBlock ( header, 8 ) || !out_stream->WriteBlock ( encoders[i].GetBuf(), len ) )
+            return false;
+    }
+
+    return true;
+}
+
+}
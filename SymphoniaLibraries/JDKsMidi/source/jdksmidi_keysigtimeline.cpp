@@ -0,0 +1,246 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/keysigtimeline.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace jdksmidi
+{
+
+// pitch class of the letters C D E F G A B
+static const int letter_pitch[7] = { 0, 2, 4, 5, 7, 9, 11 };
+static const char letter_name[7] = { 'C', 'D', 'E', 'F', 'G', 'A', 'B' };
+
+// letters which get the sharps and the flats of a key signature, in order
+static const int sharp_letters[7] = { 3, 0, 4, 1, 5, 2, 6 };
+static const int flat_letters[7] = { 6, 2, 5, 1, 4, 0, 3 };
+
+void MIDIKeySpellingTable::Build ( int sharp_flats_, bool minor_ )
+{
+    sharp_flats = std::max ( -7, std::min ( 7, sharp_flats_ ) );
+    minor = minor_;
+
+    // accidentals of the letters in the key
+    int key_acc[7] = { 0 };
+
+    for ( int i = 0; i < sharp_flats; ++i )
+        key_acc[sharp_letters[i]] = 1;
+
+    for ( int i = 0; i < -sharp_flats; ++i )
+        key_acc[flat_letters[i]] = -1;
+
+    // every sharp is a fifth up (4 letters), the minor tonic is two letters below the major one
+    int tonic_letter = ( ( 4 * sharp_flats ) % 7 + 7 ) % 7;
+
+    if ( minor )
+        tonic_letter = ( tonic_letter + 5 ) % 7;
+
+    tonic = ( letter_pitch[tonic_letter] + key_acc[tonic_letter] + 12 ) % 12;
+
+    // letter and accidental of each pitch class
+    int pc_letter[12];
+    int pc_acc[12];
+    bool pc_in_scale[12];
+
+    for ( int pc = 0; pc < 12; ++pc )
+    {
+        pc_letter[pc] = -1;
+        pc_acc[pc] = 0;
+        pc_in_scale[pc] = false;
+    }
+
+    for ( int l = 0; l < 7; ++l )
+    {
+        int pc = ( letter_pitch[l] + key_acc[l] + 12 ) % 12;
+        pc_letter[pc] = l;
+        pc_acc[pc] = key_acc[l];
+        pc_in_scale[pc] = true;
+    }
+
+    for ( int pc = 0; pc < 12; ++pc )
+    {
+        if ( pc_in_scale[pc] )
+            continue;
+
+        if ( minor && pc == ( tonic + 11 ) % 12 )
+        {
+            // leading tone, raised seventh degree
+            int l = ( tonic_letter + 6 ) % 7;
+            pc_letter[pc] = l;
+            pc_acc[pc] = key_acc[l] + 1;
+            continue;
+        }
+
+        // the letter with the fewest accidentals, on a tie sharps in sharp keys and C,
+        // flats in flat keys
+        for ( int l = 0; l < 7; ++l )
+        {
+            int acc = ( pc - letter_pitch[l] + 18 ) % 12 - 6;
+
+            if ( acc < -2 || acc > 2 )
+                continue;
+
+            if ( pc_letter[pc] < 0 || abs ( acc ) < abs ( pc_acc[pc] )
+                    || ( abs ( acc ) == abs ( pc_acc[pc] ) && ( acc > 0 ) == ( sharp_flats >= 0 ) ) )
+            {
+                pc_letter[pc] = l;
+                pc_acc[pc] = acc;
+            }
+        }
+    }
+
+    for ( int note = 0; note < 128; ++note )
+    {
+        int pc = note % 12;
+        int l = pc_letter[pc];
+        int acc = pc_acc[pc];
+        MIDINoteSpelling &s = notes[note];
+
+        int n = 0;
+        s.name[n++] = letter_name[l];
+
+        if ( acc == 2 )
+            s.name[n++] = 'x';
+        else if ( acc == 1 )
+            s.name[n++] = '#';
+
+        for ( int i = 0; i > acc; --i )
+            s.name[n++] = 'b';
+
+        s.name[n] = 0;
+
+        // the octave goes with the letter: B#3 and Cb5 are notes 60 and 71
+        s.octave = ( signed char ) ( ( note - letter_pitch[l] - acc + 12 ) / 12 - 2 );
+        s.letter = ( unsigned char ) l;
+        s.accidental = ( signed char ) acc;
+        s.degree = ( unsigned char ) ( ( l - tonic_letter + 7 ) % 7 + 1 );
+        s.interval = ( unsigned char ) ( ( pc - tonic + 12 ) % 12 );
+        s.in_scale = pc_in_scale[pc];
+    }
+}
+
+
+MIDIKeySignatureTimeline::MIDIKeySignatureTimeline()
+{
+    Clear();
+}
+
+MIDIKeySignatureTimeline::~MIDIKeySignatureTimeline()
+{
+}
+
+void MIDIKeySignatureTimeline::Clear()
+{
+    entries.clear();
+    tables.clear();
+
+    Entry e;
+    e.clock = 0;
+    e.table = GetTableNum ( 0, false );
+    entries.push_back ( e );
+}
+
+void MIDIKeySignatureTimeline::Build ( const MIDIMultiTrack *multitrack )
+{
+    Clear();
+
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = 0; i < track->GetNumEvents(); ++i )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( msg->IsKeySig() )
+                Add ( msg->GetTime(), msg->GetKeySigSharpFlats(), msg->GetKeySigMajorMinor() != 0 );
+        }
+    }
+
+    Sort();
+}
+
+void MIDIKeySignatureTimeline::Add ( MIDIClockTime clock, int sharp_flats, bool minor )
+{
+    Entry e;
+    e.clock = clock;
+    e.table = GetTableNum ( sharp_flats, minor );
+
+    // the first key at time 0 takes the place of the default C major
+    if ( clock == 0 && entries.size() == 1 )
+        entries[0] = e;
+    else
+        entries.push_back ( e );
+}
+
+void MIDIKeySignatureTimeline::Sort()
+{
+    std::stable_sort ( entries.begin(), entries.end(), [] ( const Entry & a, const Entry & b )
+    {
+        return a.clock < b.clock;
+    } );
+}
+
+int MIDIKeySignatureTimeline::FindEntryOfClock ( MIDIClockTime clock ) const
+{
+    int lo = 0;
+    int hi = ( int ) entries.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( entries[mid].clock <= clock )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+void MIDIKeySignatureTimeline::AssignTables ( const MIDITrack *track, std::vector<unsigned char> *event_tables ) const
+{
+    int num_events = track->GetNumEvents();
+    event_tables->resize ( num_events );
+
+    Cursor cursor ( this );
+
+    for ( int i = 0; i < num_events; ++i )
+        ( *event_tables ) [i] = ( unsigned char ) cursor.GetTableNumAt ( track->GetEventAddress ( i )->GetTime() );
+}
+
+int MIDIKeySignatureTimeline::GetTableNum ( int sharp_flats, bool minor )
+{
+    sharp_flats = std::max ( -7, std::min ( 7, sharp_flats ) );
+
+    for ( size_t i = 0; i < tables.size(); ++i )
+    {
+        if ( tables[i].GetSharpFlats() == sharp_flats && tables[i].IsMinor() == minor )
+            return ( int ) i;
+    }
+
+    tables.push_back ( MIDIKeySpellingTable ( sharp_flats, minor ) );
+    return ( int ) tables.size() - 1;
+}
+
+}
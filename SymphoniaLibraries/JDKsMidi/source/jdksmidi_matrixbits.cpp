@@ -0,0 +1,116 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/matrixbits.h"
+
+namespace jdksmidi
+{
+
+MIDIMatrixBits::MIDIMatrixBits()
+{
+    memset ( note_mask, 0, sizeof ( note_mask ) );
+}
+
+MIDIMatrixBits::~MIDIMatrixBits()
+{
+}
+
+void MIDIMatrixBits::Clear()
+{
+    MIDIMatrix::Clear();
+    memset ( note_mask, 0, sizeof ( note_mask ) );
+}
+
+bool MIDIMatrixBits::AnyNotesOn() const
+{
+    uint64_t any = 0;
+
+    for ( int channel = 0; channel < 16; ++channel )
+        any |= note_mask[channel][0] | note_mask[channel][1];
+
+    return any != 0;
+}
+
+unsigned int MIDIMatrixBits::GetActiveChannels() const
+{
+    unsigned int channels = 0;
+
+    for ( int channel = 0; channel < 16; ++channel )
+    {
+        if ( AnyNotesOn ( channel ) )
+            channels |= 1u << channel;
+    }
+
+    return channels;
+}
+
+int MIDIMatrixBits::GetNextNoteOn ( int channel, int note ) const
+{
+    for ( int half = note >> 6; half < 2 && note < 128; ++half )
+    {
+        // drop the notes below note in this half
+        uint64_t mask = note_mask[channel][half] >> ( note & 63 ) << ( note & 63 );
+
+        if ( mask != 0 )
+            return half * 64 + CountTrailingZeros ( mask );
+
+        note = ( half + 1 ) * 64;
+    }
+
+    return -1;
+}
+
+int MIDIMatrixBits::GetNotesOn ( int channel, unsigned char *notes ) const
+{
+    int num_notes = 0;
+
+    for ( int half = 0; half < 2; ++half )
+    {
+        for ( uint64_t mask = note_mask[channel][half]; mask != 0; mask &= mask - 1 )
+            notes[num_notes++] = ( unsigned char ) ( half * 64 + CountTrailingZeros ( mask ) );
+    }
+
+    return num_notes;
+}
+
+void MIDIMatrixBits::DecNoteCount ( const MIDIMessage &m, int channel, int note )
+{
+    MIDIMatrix::DecNoteCount ( m, channel, note );
+    UpdateNoteBit ( channel, note );
+}
+
+void MIDIMatrixBits::IncNoteCount ( const MIDIMessage &m, int channel, int note )
+{
+    MIDIMatrix::IncNoteCount ( m, channel, note );
+    UpdateNoteBit ( channel, note );
+}
+
+void MIDIMatrixBits::ClearChannel ( int channel )
+{
+    // nothing to clear if no note is on
+    if ( !AnyNotesOn ( channel ) && GetChannelCount ( channel ) == 0 )
+        return;
+
+    MIDIMatrix::ClearChannel ( channel );
+    note_mask[channel][0] = 0;
+    note_mask[channel][1] = 0;
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/multitrack.h"
+
+#include <thread>
+#include <vector>
+
+namespace jdksmidi
+{
+
+// tracks of the split: 0 for all not channel events, 1-16 for the channels
+static const int SPLIT_NUM_TRACKS = 17;
+
+// below this number of events the threads cost more than they save
+static const int SPLIT_MIN_EVENTS_PER_THREAD = 8192;
+
+static inline int GetSplitTrack ( const MIDITimedBigMessage *msg )
+{
+    return msg->IsChannelMsg() ? msg->GetChannel() + 1 : 0;
+}
+
+// run work ( n ) for n = 0 ... num - 1, each on its own thread, n = 0 on this thread
+template <class Work>
+static void RunOnThreads ( int num, Work work )
+{
+    std::vector<std::thread> workers;
+
+    for ( int n = 1; n < num; ++n )
+        workers.push_back ( std::thread ( work, n ) );
+
+    work ( 0 );
+
+    for ( size_t i = 0; i < workers.size(); ++i )
+        workers[i].join();
+}
+
+bool MIDIMultiTrack::AssignEventsToTracksParallel ( const MIDITrack *src, int num_threads )
+{
+    // a track of this multitrack would be deleted by ClearAndResize(), so it is taken over
+    // just before that. pass 1 still reads it in place
+    int src_track = -1;
+
+    for ( int i = 0; i < number_of_tracks; ++i )
+    {
+        if ( tracks[i] == src )
+        {
+            src_track = i;
+            break;
+        }
+    }
+
+    bool move_events = ( src_track >= 0 );
+    int num_events = src->GetNumEvents();
+
+    if ( num_threads <= 0 )
+        num_threads = ( int ) std::thread::hardware_concurrency();
+
+    if ( num_threads > num_events / SPLIT_MIN_EVENTS_PER_THREAD )
+        num_threads = num_events / SPLIT_MIN_EVENTS_PER_THREAD;
+
+    if ( num_threads < 1 )
+        num_threads = 1;
+
+    // pass 1: count the events of every track in each block
+    std::vector<int> block_start ( num_threads + 1 );
+
+    for ( int b = 0; b <= num_threads; ++b )
+        block_start[b] = ( int ) ( ( long long ) num_events * b / num_threads );
+
+    std::vector<int> counts ( num_threads * SPLIT_NUM_TRACKS, 0 );
+
+    RunOnThreads ( num_threads, [&] ( int b )
+    {
+        int *block_counts = &counts[b * SPLIT_NUM_TRACKS];
+
+        for ( int i = block_start[b]; i < block_start[b + 1]; ++i )
+            ++block_counts[GetSplitTrack ( src->GetEventAddress ( i ) )];
+    } );
+
+    // the place of the first event of each block in each track
+    int totals[SPLIT_NUM_TRACKS] = { 0 };
+
+    for ( int b = 0; b < num_threads; ++b )
+    {
+        for ( int t = 0; t < SPLIT_NUM_TRACKS; ++t )
+        {
+            int n = counts[b * SPLIT_NUM_TRACKS + t];
+            counts[b * SPLIT_NUM_TRACKS + t] = totals[t];
+            totals[t] += n;
+        }
+    }
+
+    MIDITrack own_track;
+
+    if ( move_events )
+    {
+        own_track = std::move ( *tracks[src_track] );
+        src = &own_track;
+    }
+
+    // on failure the taken over events are put back, so they are not lost with the tracks
+    auto restore_src = [&]()
+    {
+        if ( !move_events )
+            return;
+
+        int t = src_track < number_of_tracks ? src_track : 0;
+
+        if ( t < number_of_tracks && tracks[t] )
+            *tracks[t] = std::move ( own_track );
+    };
+
+    if ( !ClearAndResize ( SPLIT_NUM_TRACKS ) )
+    {
+        restore_src();
+        return false;
+    }
+
+    // presize the tracks, so the events can be written at their places. pass 2 writes every
+    // slot, so only the number of events is set. the chunks of a track are made on its thread
+    std::vector<char> track_ok ( SPLIT_NUM_TRACKS, 1 );
+    int num_alloc_threads = num_threads < SPLIT_NUM_TRACKS ? num_threads : SPLIT_NUM_TRACKS;
+
+    RunOnThreads ( num_alloc_threads, [&] ( int n )
+    {
+        for ( int t = n; t < SPLIT_NUM_TRACKS; t += num_alloc_threads )
+        {
+            MIDITrack *track = tracks[t];
+
+            if ( totals[t] > track->GetBufferSize() && !track->Expand ( totals[t] - track->GetBufferSize() ) )
+                track_ok[t] = 0;
+            else
+                track_ok[t] = track->SetNumEvents ( totals[t] );
+        }
+    } );
+
+    bool ok = true;
+
+    for ( int t = 0; t < SPLIT_NUM_TRACKS; ++t )
+    {
+        if ( !track_ok[t] )
+            ok = false;
+    }
+
+    if ( !ok )
+    {
+        restore_src();
+        return false;
+    }
+
+    // pass 2: every block writes its events after the events of the blocks before it
+    RunOnThreads ( num_threads, [&] ( int b )
+    {
+        int *next = &counts[b * SPLIT_NUM_TRACKS];
+
+        for ( int i = block_start[b]; i < block_start[b + 1]; ++i )
+        {
+            const MIDITimedBigMessage *msg = src->GetEventAddress ( i );
+            int t = GetSplitTrack ( msg );
+            MIDITimedBigMessage *dest = tracks[t]->GetEventAddress ( next[t]++ );
+
+            if ( move_events )
+                *dest = std::move ( *own_track.GetEventAddress ( i ) );
+            else
+                *dest = *msg;
+        }
+    } );
+
+    return true;
+}
+
+}
@@ -0,0 +1,164 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/packedevent.h"
+
+namespace jdksmidi
+{
+
+static_assert ( sizeof ( MIDIPackedEvent ) == 8, "MIDIPackedEvent must be 8 bytes" );
+
+
+MIDIPackedPayloadPool::MIDIPackedPayloadPool()
+{
+}
+
+MIDIPackedPayloadPool::~MIDIPackedPayloadPool()
+{
+}
+
+void MIDIPackedPayloadPool::Clear()
+{
+    payloads.clear();
+    sysex_pool.Clear();
+}
+
+long MIDIPackedPayloadPool::Add ( const MIDIBigMessage &msg )
+{
+    if ( payloads.size() > MIDIPackedEvent::MAX_PAYLOAD_INDEX )
+        return -1;
+
+    Payload p;
+    p.msg = msg;
+    p.sysex_blob = msg.GetSysEx() ? sysex_pool.Intern ( *msg.GetSysEx() ) : ( long ) MIDISysExPool::NO_BLOB;
+
+    payloads.push_back ( p );
+    return ( long ) payloads.size() - 1;
+}
+
+void MIDIPackedPayloadPool::Get ( unsigned long index, MIDIBigMessage *msg ) const
+{
+    const Payload &p = payloads[index];
+
+    // assigning a MIDIMessage clears the sysex of msg
+    *msg = p.msg;
+
+    if ( p.sysex_blob != MIDISysExPool::NO_BLOB )
+    {
+        // a not deletable sysex on the blob, CopySysEx() makes the message own copy
+        int len = sysex_pool.GetLength ( p.sysex_blob );
+        MIDISystemExclusive sysex ( const_cast<unsigned char *> ( sysex_pool.GetData ( p.sysex_blob ) ), len, len, false );
+        msg->CopySysEx ( &sysex );
+    }
+}
+
+const unsigned char *MIDIPackedPayloadPool::GetSysExData ( unsigned long index, int *len ) const
+{
+    const Payload &p = payloads[index];
+
+    if ( p.sysex_blob == MIDISysExPool::NO_BLOB )
+    {
+        *len = 0;
+        return 0;
+    }
+
+    *len = sysex_pool.GetLength ( p.sysex_blob );
+    return sysex_pool.GetData ( p.sysex_blob );
+}
+
+
+MIDIPackedTrack::MIDIPackedTrack ( MIDIPackedPayloadPool *pool_ )
+    : pool ( pool_ )
+{
+}
+
+MIDIPackedTrack::~MIDIPackedTrack()
+{
+}
+
+bool MIDIPackedTrack::PutEvent ( const MIDITimedBigMessage &msg )
+{
+    MIDIPackedEvent ev ( msg.GetTime(), msg.GetStatus(), msg.GetByte1(), msg.GetByte2() );
+
+    // only plain channel messages are stored in the event itself
+    if ( msg.IsServiceMsg() || msg.GetSysEx() || msg.GetStatus() < 0x80 || msg.GetStatus() >= 0xf0 )
+    {
+        long index = pool->Add ( msg );
+
+        if ( index < 0 )
+            return false;
+
+        ev.SetPayloadIndex ( ( unsigned long ) index );
+    }
+
+    events.push_back ( ev );
+    return true;
+}
+
+void MIDIPackedTrack::GetEvent ( int event_num, MIDITimedBigMessage *msg ) const
+{
+    const MIDIPackedEvent &ev = events[event_num];
+
+    if ( ev.HasPayload() )
+    {
+        pool->Get ( ev.GetPayloadIndex(), msg );
+    }
+    else
+    {
+        msg->Clear();
+        msg->SetStatus ( ev.GetStatus() );
+        msg->SetByte1 ( ev.GetByte1() );
+        msg->SetByte2 ( ev.GetByte2() );
+    }
+
+    msg->SetTime ( ev.GetTime() );
+}
+
+bool MIDIPackedTrack::FromTrack ( const MIDITrack *track )
+{
+    events.clear();
+    events.reserve ( track->GetNumEvents() );
+
+    for ( int i = 0; i < track->GetNumEvents(); ++i )
+    {
+        if ( !PutEvent ( *track->GetEventAddress ( i ) ) )
+            return false;
+    }
+
+    return true;
+}
+
+bool MIDIPackedTrack::ToTrack ( MIDITrack *track ) const
+{
+    MIDITimedBigMessage msg;
+
+    for ( int i = 0; i < GetNumEvents(); ++i )
+    {
+        GetEvent ( i, &msg );
+
+        // msg is filled again by the next GetEvent(), so its sysex can be moved into the track
+        if ( !track->PutEvent ( std::move ( msg ) ) )
+            return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,380 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/packedtransform.h"
+#include "jdksmidi/process.h"
+#include "jdksmidi/sequencer.h"
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+#define JDKSMIDI_PACKEDTRANSFORM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace jdksmidi
+{
+
+MIDIPackedTransform::MIDIPackedTransform()
+{
+    Clear();
+}
+
+MIDIPackedTransform::~MIDIPackedTransform()
+{
+}
+
+void MIDIPackedTransform::Clear()
+{
+    for ( int chan = 0; chan < 16; ++chan )
+    {
+        transpose[chan] = 0;
+        velocity_scale[chan] = 100;
+        rechannel[chan] = ( signed char ) chan;
+    }
+
+    drop_out_of_range = false;
+}
+
+void MIDIPackedTransform::SetTranspose ( int chan, int trans )
+{
+    if ( trans < -127 )
+        trans = -127;
+
+    if ( trans > 127 )
+        trans = 127;
+
+    transpose[chan] = ( signed char ) trans;
+}
+
+void MIDIPackedTransform::SetAllTranspose ( int trans )
+{
+    for ( int chan = 0; chan < 16; ++chan )
+        SetTranspose ( chan, trans );
+}
+
+void MIDIPackedTransform::SetVelocityScale ( int chan, int percent )
+{
+    if ( percent < 0 )
+        percent = 0;
+
+    if ( percent > 0xffff )
+        percent = 0xffff;
+
+    velocity_scale[chan] = ( unsigned short ) percent;
+}
+
+void MIDIPackedTransform::SetAllVelocityScale ( int percent )
+{
+    for ( int chan = 0; chan < 16; ++chan )
+        SetVelocityScale ( chan, percent );
+}
+
+void MIDIPackedTransform::SetRechannel ( int src_chan, int dest_chan )
+{
+    rechannel[src_chan] = ( signed char ) ( dest_chan < 0 ? -1 : ( dest_chan & 0x0f ) );
+}
+
+void MIDIPackedTransform::SetAllRechannel ( int dest_chan )
+{
+    for ( int chan = 0; chan < 16; ++chan )
+        SetRechannel ( chan, dest_chan );
+}
+
+void MIDIPackedTransform::SetFromTransposer ( const MIDIProcessorTransposer &proc )
+{
+    for ( int chan = 0; chan < 16; ++chan )
+        SetTranspose ( chan, proc.GetTransposeChannel ( chan ) );
+
+    drop_out_of_range = true;
+}
+
+void MIDIPackedTransform::SetFromRechannelizer ( const MIDIProcessorRechannelizer &proc )
+{
+    for ( int chan = 0; chan < 16; ++chan )
+        SetRechannel ( chan, proc.GetRechanMap ( chan ) );
+}
+
+void MIDIPackedTransform::SetFromTrackProcessor ( const MIDISequencerTrackProcessor &proc )
+{
+    SetAllTranspose ( proc.transpose );
+    SetAllVelocityScale ( proc.velocity_scale );
+
+    // -1 is no rechannelization in the track processor
+    for ( int chan = 0; chan < 16; ++chan )
+        SetRechannel ( chan, proc.rechannel == -1 ? chan : proc.rechannel );
+
+    drop_out_of_range = true;
+}
+
+int MIDIPackedTransform::ApplyScalar ( unsigned char *status, unsigned char *byte1, unsigned char *byte2, int num ) const
+{
+    int dropped = 0;
+
+    for ( int i = 0; i < num; ++i )
+    {
+        int s = status[i];
+
+        if ( s < 0x80 || s >= 0xf0 )
+            continue;
+
+        int type = s & 0xf0;
+        int chan = s & 0x0f;
+        bool drop = ( rechannel[chan] < 0 );
+
+        if ( type == NOTE_ON || type == NOTE_OFF || type == POLY_PRESSURE )
+        {
+            int note = byte1[i] + transpose[chan];
+
+            if ( note < 0 || note > 127 )
+            {
+                drop = drop || drop_out_of_range;
+                note = note < 0 ? 0 : 127;
+            }
+
+            byte1[i] = ( unsigned char ) note;
+        }
+
+        if ( type == NOTE_ON && byte2[i] != 0 )
+        {
+            int vel = byte2[i] * velocity_scale[chan] / 100;
+            byte2[i] = ( unsigned char ) ( vel < 1 ? 1 : vel > 127 ? 127 : vel );
+        }
+
+        if ( drop )
+        {
+            status[i] = 0;
+            ++dropped;
+        }
+        else
+        {
+            status[i] = ( unsigned char ) ( type | rechannel[chan] );
+        }
+    }
+
+    return dropped;
+}
+
+#ifdef JDKSMIDI_PACKEDTRANSFORM_SSE2
+
+static inline __m128i Select ( __m128i mask, __m128i a, __m128i b )
+{
+    return _mm_or_si128 ( _mm_and_si128 ( mask, a ), _mm_andnot_si128 ( mask, b ) );
+}
+
+// per byte lane: table[chan]. channels with the value of table[0] cost nothing, and a table
+// which maps every channel to itself is the channel
+static inline __m128i LookupChannel8 ( __m128i chan, const signed char *table, bool identity = false )
+{
+    if ( identity )
+        return chan;
+
+    __m128i r = _mm_set1_epi8 ( table[0] );
+
+    for ( int c = 1; c < 16; ++c )
+    {
+        if ( table[c] != table[0] )
+            r = Select ( _mm_cmpeq_epi8 ( chan, _mm_set1_epi8 ( ( char ) c ) ), _mm_set1_epi8 ( table[c] ), r );
+    }
+
+    return r;
+}
+
+// the same for 16 bit lanes
+static inline __m128i LookupChannel16 ( __m128i chan, const unsigned short *table )
+{
+    __m128i r = _mm_set1_epi16 ( ( short ) table[0] );
+
+    for ( int c = 1; c < 16; ++c )
+    {
+        if ( table[c] != table[0] )
+            r = Select ( _mm_cmpeq_epi16 ( chan, _mm_set1_epi16 ( ( short ) c ) ), _mm_set1_epi16 ( ( short ) table[c] ), r );
+    }
+
+    return r;
+}
+
+// new notes of 8 notes in 16 bit lanes, *out_of_range gets the lanes which were clamped
+static inline __m128i TransposeNotes ( __m128i note, __m128i trans, __m128i *out_of_range )
+{
+    __m128i sum = _mm_add_epi16 ( note, trans );
+    __m128i clamped = _mm_min_epi16 ( _mm_max_epi16 ( sum, _mm_setzero_si128() ), _mm_set1_epi16 ( 127 ) );
+    *out_of_range = _mm_xor_si128 ( _mm_cmpeq_epi16 ( sum, clamped ), _mm_set1_epi16 ( -1 ) );
+    return clamped;
+}
+
+// vel * scale / 100 clamped to 1...127 for 8 velocities in 16 bit lanes. a product above
+// 12799 gives 127 anyway, so it is limited to that and the division is exact with a multiply
+static inline __m128i ScaleVelocities ( __m128i vel, __m128i scale )
+{
+    const __m128i limit = _mm_set1_epi16 ( 12799 );
+    __m128i lo = _mm_mullo_epi16 ( vel, scale );
+    __m128i hi = _mm_mulhi_epu16 ( vel, scale );
+    __m128i small = _mm_and_si128 ( _mm_cmpeq_epi16 ( hi, _mm_setzero_si128() ),
+                                    _mm_cmpeq_epi16 ( _mm_subs_epu16 ( lo, limit ), _mm_setzero_si128() ) );
+    __m128i product = Select ( small, lo, limit );
+    __m128i q = _mm_srli_epi16 ( _mm_mulhi_epu16 ( product, _mm_set1_epi16 ( ( short ) 41944 ) ), 6 );
+    return _mm_max_epi16 ( q, _mm_set1_epi16 ( 1 ) );
+}
+
+int MIDIPackedTransform::Apply ( unsigned char *status, unsigned char *byte1, unsigned char *byte2, int num ) const
+{
+    const __m128i zero = _mm_setzero_si128();
+    int dropped = 0;
+    int i = 0;
+
+    // local copies, so the stores to the byte arrays do not make the compiler reload them
+    signed char trans_table[16];
+    signed char rechan_table[16];
+    unsigned short scale_table[16];
+    bool rechan_identity = true;
+
+    for ( int chan = 0; chan < 16; ++chan )
+    {
+        trans_table[chan] = transpose[chan];
+        rechan_table[chan] = rechannel[chan];
+        scale_table[chan] = velocity_scale[chan];
+        rechan_identity = rechan_identity && rechannel[chan] == chan;
+    }
+
+    bool drop_oor = drop_out_of_range;
+
+    for ( ; i + 16 <= num; i += 16 )
+    {
+        __m128i s = _mm_loadu_si128 ( ( const __m128i * ) ( status + i ) );
+        __m128i n = _mm_loadu_si128 ( ( const __m128i * ) ( byte1 + i ) );
+        __m128i v = _mm_loadu_si128 ( ( const __m128i * ) ( byte2 + i ) );
+
+        // 0x80...0xef are 0x00...0x6f after flipping the top bit
+        __m128i x = _mm_xor_si128 ( s, _mm_set1_epi8 ( ( char ) 0x80 ) );
+        __m128i is_chan = _mm_and_si128 ( _mm_cmpgt_epi8 ( x, _mm_set1_epi8 ( -1 ) ), _mm_cmplt_epi8 ( x, _mm_set1_epi8 ( 0x70 ) ) );
+
+        if ( _mm_movemask_epi8 ( is_chan ) == 0 )
+            continue;
+
+        __m128i type = _mm_and_si128 ( s, _mm_set1_epi8 ( ( char ) 0xf0 ) );
+        __m128i chan = _mm_and_si128 ( s, _mm_set1_epi8 ( 0x0f ) );
+        __m128i is_note_on = _mm_cmpeq_epi8 ( type, _mm_set1_epi8 ( ( char ) NOTE_ON ) );
+        __m128i is_note = _mm_or_si128 ( is_note_on, _mm_or_si128 (
+                                             _mm_cmpeq_epi8 ( type, _mm_set1_epi8 ( ( char ) NOTE_OFF ) ),
+                                             _mm_cmpeq_epi8 ( type, _mm_set1_epi8 ( ( char ) POLY_PRESSURE ) ) ) );
+        is_note = _mm_and_si128 ( is_note, is_chan );
+        __m128i is_vel = _mm_and_si128 ( _mm_andnot_si128 ( _mm_cmpeq_epi8 ( v, zero ), is_note_on ), is_chan );
+
+        // rechannelize, channels to -1 are dropped
+        __m128i dest = LookupChannel8 ( chan, rechan_table, rechan_identity );
+        __m128i drop = _mm_and_si128 ( is_chan, _mm_cmplt_epi8 ( dest, zero ) );
+        __m128i new_s = _mm_or_si128 ( type, _mm_and_si128 ( dest, _mm_set1_epi8 ( 0x0f ) ) );
+
+        // transpose in 16 bits, the amount sign extended
+        __m128i trans = LookupChannel8 ( chan, trans_table );
+        __m128i trans_sign = _mm_cmpgt_epi8 ( zero, trans );
+        __m128i oor_lo, oor_hi;
+        __m128i note_lo = TransposeNotes ( _mm_unpacklo_epi8 ( n, zero ), _mm_unpacklo_epi8 ( trans, trans_sign ), &oor_lo );
+        __m128i note_hi = TransposeNotes ( _mm_unpackhi_epi8 ( n, zero ), _mm_unpackhi_epi8 ( trans, trans_sign ), &oor_hi );
+        n = Select ( is_note, _mm_packus_epi16 ( note_lo, note_hi ), n );
+
+        if ( drop_oor )
+            drop = _mm_or_si128 ( drop, _mm_and_si128 ( is_note, _mm_packs_epi16 ( oor_lo, oor_hi ) ) );
+
+        // scale velocities of note ons
+        if ( _mm_movemask_epi8 ( is_vel ) != 0 )
+        {
+            __m128i vel_lo = ScaleVelocities ( _mm_unpacklo_epi8 ( v, zero ), LookupChannel16 ( _mm_unpacklo_epi8 ( chan, zero ), scale_table ) );
+            __m128i vel_hi = ScaleVelocities ( _mm_unpackhi_epi8 ( v, zero ), LookupChannel16 ( _mm_unpackhi_epi8 ( chan, zero ), scale_table ) );
+            v = Select ( is_vel, _mm_packus_epi16 ( vel_lo, vel_hi ), v );
+        }
+
+        s = _mm_andnot_si128 ( drop, Select ( is_chan, new_s, s ) );
+
+        _mm_storeu_si128 ( ( __m128i * ) ( status + i ), s );
+        _mm_storeu_si128 ( ( __m128i * ) ( byte1 + i ), n );
+        _mm_storeu_si128 ( ( __m128i * ) ( byte2 + i ), v );
+
+        for ( int bits = _mm_movemask_epi8 ( drop ); bits != 0; bits &= bits - 1 )
+            ++dropped;
+    }
+
+    return dropped + ApplyScalar ( status + i, byte1 + i, byte2 + i, num - i );
+}
+
+#else
+
+int MIDIPackedTransform::Apply ( unsigned char *status, unsigned char *byte1, unsigned char *byte2, int num ) const
+{
+    return ApplyScalar ( status, byte1, byte2, num );
+}
+
+#endif
+
+int MIDIPackedTransform::Apply ( MIDIPackedTrack *track ) const
+{
+    const int block_size = 256;
+    unsigned char status[block_size];
+    unsigned char byte1[block_size];
+    unsigned char byte2[block_size];
+    int num_events = track->GetNumEvents();
+    int dropped = 0;
+
+    for ( int first = 0; first < num_events; first += block_size )
+    {
+        int num = num_events - first < block_size ? num_events - first : block_size;
+
+        // events with payload are not channel messages, 0xf0 leaves them alone
+        for ( int i = 0; i < num; ++i )
+        {
+            const MIDIPackedEvent *ev = track->GetEventAddress ( first + i );
+            status[i] = ev->HasPayload() ? 0xf0 : ev->status;
+            byte1[i] = ev->d1;
+            byte2[i] = ev->d2;
+        }
+
+        dropped += Apply ( status, byte1, byte2, num );
+
+        for ( int i = 0; i < num; ++i )
+        {
+            MIDIPackedEvent *ev = track->GetEventAddress ( first + i );
+
+            if ( !ev->HasPayload() )
+            {
+                ev->status = status[i];
+                ev->d1 = byte1[i];
+                ev->d2 = byte2[i];
+            }
+        }
+    }
+
+    if ( dropped > 0 )
+    {
+        int kept = 0;
+
+        for ( int i = 0; i < num_events; ++i )
+        {
+            const MIDIPackedEvent *ev = track->GetEventAddress ( i );
+
+            if ( ev->HasPayload() || ev->status != 0 )
+                *track->GetEventAddress ( kept++ ) = *ev;
+        }
+
+        track->Resize ( kept );
+    }
+
+    return dropped;
+}
+
+}
@@ -0,0 +1,266 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/sequencersnapshot.h"
+
+namespace jdksmidi
+{
+
+MIDISequencerSnapshotNames::MIDISequencerSnapshotNames()
+{
+}
+
+MIDISequencerSnapshotNames::~MIDISequencerSnapshotNames()
+{
+}
+
+void MIDISequencerSnapshotNames::Clear()
+{
+    names.clear();
+    name_nums.clear();
+}
+
+int MIDISequencerSnapshotNames::Intern ( const char *name )
+{
+    std::string s ( name );
+    std::unordered_map<std::string, int>::const_iterator it = name_nums.find ( s );
+
+    if ( it != name_nums.end() )
+        return it->second;
+
+    int name_num = ( int ) names.size();
+    names.push_back ( s );
+    name_nums[s] = name_num;
+    return name_num;
+}
+
+
+MIDISequencerSnapshot::MIDISequencerSnapshot()
+{
+    Clear();
+}
+
+MIDISequencerSnapshot::~MIDISequencerSnapshot()
+{
+}
+
+void MIDISequencerSnapshot::Clear()
+{
+    tracks.clear();
+    note_masks.clear();
+    note_counts.clear();
+
+    iterator_cur_time = 0;
+    iterator_cur_event_track = -1;
+
+    cur_clock = 0;
+    cur_time_ms = 0.0f;
+    cur_beat = 0;
+    cur_measure = 0;
+    next_beat_time = 0;
+}
+
+void MIDISequencerSnapshot::Capture ( const MIDISequencerState &state, MIDISequencerSnapshotNames *names )
+{
+    Clear();
+
+    const MIDIMultiTrackIteratorState &it_state = state.iterator.GetState();
+
+    iterator_cur_time = it_state.cur_time;
+    iterator_cur_event_track = it_state.cur_event_track;
+
+    cur_clock = state.cur_clock;
+    cur_time_ms = state.cur_time_ms;
+    cur_beat = state.cur_beat;
+    cur_measure = state.cur_measure;
+    next_beat_time = state.next_beat_time;
+
+    tracks.resize ( state.num_tracks );
+
+    for ( int i = 0; i < state.num_tracks; ++i )
+    {
+        const MIDISequencerTrackState *ts = state.track_state[i];
+        const MIDIMatrix &matrix = ts->note_matrix;
+        TrackSnapshot &t = tracks[i];
+
+        t.tempobpm = ts->tempobpm;
+        t.pg = ts->pg;
+        t.volume = ts->volume;
+        t.timesig_numerator = ts->timesig_numerator;
+        t.timesig_denominator = ts->timesig_denominator;
+        t.bender_value = ts->bender_value;
+        t.name_num = names->Intern ( ts->track_name );
+        t.got_good_track_name = ts->got_good_track_name;
+        t.notes_are_on = ts->notes_are_on;
+
+        t.next_event_number = ( i < it_state.num_tracks ) ? it_state.next_event_number[i] : 0;
+        t.next_event_time = ( i < it_state.num_tracks ) ? it_state.next_event_time[i] : 0;
+
+        t.active_channels = 0;
+        t.hold_pedals = 0;
+        t.first_mask = ( unsigned long ) note_masks.size();
+        t.first_count = ( unsigned long ) note_counts.size();
+        t.num_counts = 0;
+
+        for ( int channel = 0; channel < 16; ++channel )
+        {
+            if ( matrix.GetHoldPedal ( channel ) )
+                t.hold_pedals |= ( uint16_t ) ( 1 << channel );
+
+            if ( matrix.GetChannelCount ( channel ) <= 0 )
+                continue;
+
+            uint64_t mask[2] = { 0, 0 };
+
+            for ( int note = 0; note < 128; ++note )
+            {
+                int count = matrix.GetNoteCount ( channel, note );
+
+                if ( count == 0 )
+                    continue;
+
+                mask[note >> 6] |= ( uint64_t ) 1 << ( note & 63 );
+
+                if ( count > 1 )
+                {
+                    NoteCount nc;
+                    nc.channel = ( unsigned char ) channel;
+                    nc.note = ( unsigned char ) note;
+                    nc.count = ( unsigned char ) count;
+                    note_counts.push_back ( nc );
+                    ++t.num_counts;
+                }
+            }
+
+            t.active_channels |= ( uint16_t ) ( 1 << channel );
+            note_masks.push_back ( mask[0] );
+            note_masks.push_back ( mask[1] );
+        }
+    }
+}
+
+void MIDISequencerSnapshot::Restore ( MIDISequencerState *state, const MIDISequencerSnapshotNames &names ) const
+{
+    MIDIMultiTrackIteratorState &it_state = state->iterator.GetState();
+
+    it_state.cur_time = iterator_cur_time;
+    it_state.cur_event_track = iterator_cur_event_track;
+
+    state->cur_clock = cur_clock;
+    state->cur_time_ms = cur_time_ms;
+    state->cur_beat = cur_beat;
+    state->cur_measure = cur_measure;
+    state->next_beat_time = next_beat_time;
+
+    int num_tracks = std::min ( GetNumTracks(), state->num_tracks );
+
+    for ( int i = 0; i < num_tracks; ++i )
+    {
+        MIDISequencerTrackState *ts = state->track_state[i];
+        const TrackSnapshot &t = tracks[i];
+
+        ts->tempobpm = t.tempobpm;
+        ts->pg = t.pg;
+        ts->volume = t.volume;
+        ts->timesig_numerator = t.timesig_numerator;
+        ts->timesig_denominator = t.timesig_denominator;
+        ts->bender_value = t.bender_value;
+        strncpy ( ts->track_name, names.GetName ( t.name_num ), sizeof ( ts->track_name ) - 1 );
+        ts->track_name[sizeof ( ts->track_name ) - 1] = 0;
+        ts->got_good_track_name = t.got_good_track_name;
+        ts->notes_are_on = t.notes_are_on;
+
+        if ( i < it_state.num_tracks )
+        {
+            it_state.next_event_number[i] = t.next_event_number;
+            it_state.next_event_time[i] = t.next_event_time;
+        }
+
+        // the matrix counters are private, so the notes are played into a cleared matrix
+        MIDIMatrix &matrix = ts->note_matrix;
+        MIDIMessage msg;
+        unsigned long mask_index = t.first_mask;
+
+        matrix.Clear();
+
+        for ( int channel = 0; channel < 16; ++channel )
+        {
+            if ( t.hold_pedals & ( 1 << channel ) )
+            {
+                msg.SetControlChange ( ( unsigned char ) channel, C_DAMPER, 127 );
+                matrix.Process ( msg );
+            }
+
+            if ( ( t.active_channels & ( 1 << channel ) ) == 0 )
+                continue;
+
+            for ( int half = 0; half < 2; ++half, ++mask_index )
+            {
+                uint64_t mask = note_masks[mask_index];
+
+                for ( int bit = 0; mask != 0; ++bit, mask >>= 1 )
+                {
+                    if ( ( mask & 1 ) == 0 )
+                        continue;
+
+                    msg.SetNoteOn ( ( unsigned char ) channel, ( unsigned char ) ( half * 64 + bit ), 127 );
+                    matrix.Process ( msg );
+                }
+            }
+        }
+
+        // notes which were on more than once
+        for ( unsigned long n = t.first_count; n < t.first_count + t.num_counts; ++n )
+        {
+            const NoteCount &nc = note_counts[n];
+            msg.SetNoteOn ( nc.channel, nc.note, 127 );
+
+            for ( int c = 1; c < nc.count; ++c )
+                matrix.Process ( msg );
+        }
+    }
+
+    // tracks which the snapshot does not have would keep the values of the previous song.
+    // they get the values of GoToZero(), without the notifications
+    for ( int i = num_tracks; i < state->num_tracks; ++i )
+    {
+        MIDISequencerTrackState *ts = state->track_state[i];
+
+        ts->tempobpm = 120.0f;
+        ts->pg = -1;
+        ts->volume = 100;
+        ts->timesig_numerator = 4;
+        ts->timesig_denominator = 4;
+        ts->bender_value = 0;
+        ts->track_name[0] = 0;
+        ts->got_good_track_name = false;
+        ts->notes_are_on = false;
+        ts->note_matrix.Clear();
+    }
+
+    // and have no more events at this position
+    for ( int i = num_tracks; i < it_state.num_tracks; ++i )
+    {
+        it_state.next_event_number[i] = -1;
+        it_state.next_event_time[i] = ( MIDIClockTime ) 0xffffffffUL;
+    }
+}
+
+}
@@ -0,0 +1,378 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/showcontrolparser.h"
+
+namespace jdksmidi
+{
+
+bool MIDIShowControlParser::IsShowControl ( const uchar *data, int len )
+{
+    if ( len > 0 && data[0] == 0xf0 )
+    {
+        ++data;
+        --len;
+    }
+
+    return len >= 5 && data[0] == 0x7f && data[2] == 0x02;
+}
+
+bool MIDIShowControlParser::Parse ( const uchar *data, int len, MIDIShowControlCommand *cmd )
+{
+    const uchar *p = data;
+    const uchar *end = data + ( len > 0 ? len : 0 );
+
+    if ( p < end && *p == 0xf0 )
+        ++p;
+
+    if ( p < end && end[-1] == 0xf7 )
+        --end;
+
+    // 0x7f device_id 0x02 command_format command
+    if ( end - p < 5 || p[0] != 0x7f || p[2] != 0x02 )
+        return false;
+
+    *cmd = MIDIShowControlCommand();
+    cmd->device_id = p[1];
+    cmd->command_format = p[3];
+    cmd->command = p[4];
+    p += 5;
+
+    switch ( cmd->command )
+    {
+    case MIDI_SC_GO:
+    case MIDI_SC_STOP:
+    case MIDI_SC_RESUME:
+    case MIDI_SC_LOAD:
+    case MIDI_SC_GO_OFF:
+    case MIDI_SC_GO_JAM:
+        return ParseCues ( &p, end, cmd, 0 );
+
+    case MIDI_SC_TIMED_GO:
+        return ParseTime ( &p, end, cmd ) && ParseCues ( &p, end, cmd, 0 );
+
+    case MIDI_SC_SET:
+        // control number and value, 14 bits each, lsb first
+        if ( end - p < 4 )
+            return false;
+
+        cmd->val1 = p[0] | ( ( ulong ) p[1] << 7 );
+        cmd->val2 = p[2] | ( ( ulong ) p[3] << 7 );
+        p += 4;
+        return p == end || ParseTime ( &p, end, cmd );
+
+    case MIDI_SC_FIRE:
+        if ( end - p < 1 )
+            return false;
+
+        cmd->val1 = p[0];
+        return true;
+
+    case MIDI_SC_STANDBY_PLUS:
+    case MIDI_SC_STANDBY_MINUS:
+    case MIDI_SC_SEQUENCE_PLUS:
+    case MIDI_SC_SEQUENCE_MINUS:
+    case MIDI_SC_START_CLOCK:
+    case MIDI_SC_STOP_CLOCK:
+    case MIDI_SC_ZERO_CLOCK:
+    case MIDI_SC_MTC_CHASE_ON:
+    case MIDI_SC_MTC_CHASE_OFF:
+    case MIDI_SC_OPEN_Q_LIST:
+    case MIDI_SC_CLOSE_Q_LIST:
+        return ParseCues ( &p, end, cmd, 1 );
+
+    case MIDI_SC_SET_CLOCK:
+        return ParseTime ( &p, end, cmd ) && ParseCues ( &p, end, cmd, 1 );
+
+    case MIDI_SC_OPEN_Q_PATH:
+    case MIDI_SC_CLOSE_Q_PATH:
+        return ParseCues ( &p, end, cmd, 2 );
+
+    default:
+        // all off, restore, reset and commands without data; unknown commands are
+        // left to the dispatcher
+        return true;
+    }
+}
+
+bool MIDIShowControlParser::ParseCues ( const uchar **p, const uchar *end, MIDIShowControlCommand *cmd, int first_cue )
+{
+    MIDIShowControlCue *cues[3] = { &cmd->q_number, &cmd->q_list, &cmd->q_path };
+
+    // the cues are separated by 0
+    for ( int n = first_cue; n < 3 && *p < end; ++n )
+    {
+        if ( !ParseCue ( p, end, cues[n] ) )
+            return false;
+
+        if ( cues[n]->num_values > 0 )
+            cmd->flags |= ( uchar ) ( MIDIShowControlCommand::HAS_Q_NUMBER << n );
+
+        if ( *p < end )
+            ++*p;
+    }
+
+    return true;
+}
+
+bool MIDIShowControlParser::ParseCue ( const uchar **p, const uchar *end, MIDIShowControlCue *cue )
+{
+    int k = 0;
+    bool any = false;
+
+    for ( ; *p < end && **p != 0; ++*p )
+    {
+        uchar c = **p;
+
+        if ( c >= '0' && c <= '9' )
+        {
+            cue->value[k] = cue->value[k] * 10 + ( c - '0' );
+            any = true;
+        }
+        else if ( c == '.' && k < 2 )
+        {
+            ++k;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    cue->num_values = any ? k + 1 : 0;
+    return true;
+}
+
+bool MIDIShowControlParser::ParseTime ( const uchar **p, const uchar *end, MIDIShowControlCommand *cmd )
+{
+    if ( end - *p < 5 )
+        return false;
+
+    const uchar *t = *p;
+    cmd->hours = t[0];
+    cmd->minutes = t[1];
+    cmd->seconds = t[2];
+    cmd->frames = t[3];
+    cmd->fract_frames = t[4];
+    cmd->flags |= MIDIShowControlCommand::HAS_TIME;
+    *p += 5;
+    return true;
+}
+
+
+// number of cues given: the number, the number and list, or all three
+static int GetNumCues ( const MIDIShowControlCommand &cmd )
+{
+    if ( !cmd.HasQNumber() )
+        return 0;
+
+    if ( !cmd.HasQList() )
+        return 1;
+
+    return cmd.HasQPath() ? 3 : 2;
+}
+
+// go, stop, resume, go off and go jam
+template < bool ( MIDISCHandle::*F0 ) (),
+           bool ( MIDISCHandle::*F1 ) ( const MIDICue & ),
+           bool ( MIDISCHandle::*F2 ) ( const MIDICue &, const MIDICue & ),
+           bool ( MIDISCHandle::*F3 ) ( const MIDICue &, const MIDICue &, const MIDICue & ) >
+static bool DispatchCues ( MIDISCHandle *h, const MIDIShowControlCommand &cmd )
+{
+    switch ( GetNumCues ( cmd ) )
+    {
+    case 0:
+        return ( h->*F0 ) ();
+
+    case 1:
+        return ( h->*F1 ) ( cmd.q_number.ToCue() );
+
+    case 2:
+        return ( h->*F2 ) ( cmd.q_number.ToCue(), cmd.q_list.ToCue() );
+
+    default:
+        return ( h->*F3 ) ( cmd.q_number.ToCue(), cmd.q_list.ToCue(), cmd.q_path.ToCue() );
+    }
+}
+
+// standby, sequence, clock and chase commands with an optional cue list
+template < bool ( MIDISCHandle::*F0 ) (), bool ( MIDISCHandle::*F1 ) ( const MIDICue & ) >
+static bool DispatchList ( MIDISCHandle *h, const MIDIShowControlCommand &cmd )
+{
+    return cmd.HasQList() ? ( h->*F1 ) ( cmd.q_list.ToCue() ) : ( h->*F0 ) ();
+}
+
+// commands with just a cue list or path
+template < bool ( MIDISCHandle::*F1 ) ( const MIDICue & ) >
+static bool DispatchListOnly ( MIDISCHandle *h, const MIDIShowControlCommand &cmd )
+{
+    return cmd.HasQList() ? ( h->*F1 ) ( cmd.q_list.ToCue() ) : false;
+}
+
+template < bool ( MIDISCHandle::*F1 ) ( const MIDICue & ) >
+static bool DispatchPathOnly ( MIDISCHandle *h, const MIDIShowControlCommand &cmd )
+{
+    return cmd.HasQPath() ? ( h->*F1 ) ( cmd.q_path.ToCue() ) : false;
+}
+
+static bool DispatchTimedGo ( MIDISCHandle *h, const MIDIShowControlCommand &c )
+{
+    switch ( GetNumCues ( c ) )
+    {
+    case 0:
+        return h->TimedGo ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames );
+
+    case 1:
+        return h->TimedGo ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames, c.q_number.ToCue() );
+
+    case 2:
+        return h->TimedGo ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames, c.q_number.ToCue(), c.q_list.ToCue() );
+
+    default:
+        return h->TimedGo ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames,
+                            c.q_number.ToCue(), c.q_list.ToCue(), c.q_path.ToCue() );
+    }
+}
+
+static bool DispatchLoad ( MIDISCHandle *h, const MIDIShowControlCommand &c )
+{
+    switch ( GetNumCues ( c ) )
+    {
+    case 0:
+        return false;
+
+    case 1:
+        return h->Load ( c.q_number.ToCue() );
+
+    case 2:
+        return h->Load ( c.q_number.ToCue(), c.q_list.ToCue() );
+
+    default:
+        return h->Load ( c.q_number.ToCue(), c.q_list.ToCue(), c.q_path.ToCue() );
+    }
+}
+
+static bool DispatchSet ( MIDISCHandle *h, const MIDIShowControlCommand &c )
+{
+    if ( c.HasTime() )
+        return h->Set ( c.val1, c.val2, c.hours, c.minutes, c.seconds, c.frames, c.fract_frames );
+
+    return h->Set ( c.val1, c.val2 );
+}
+
+static bool DispatchFire ( MIDISCHandle *h, const MIDIShowControlCommand &c )
+{
+    return h->Fire ( ( uchar ) c.val1 );
+}
+
+static bool DispatchAllOff ( MIDISCHandle *h, const MIDIShowControlCommand & )
+{
+    return h->AllOff();
+}
+
+static bool DispatchRestore ( MIDISCHandle *h, const MIDIShowControlCommand & )
+{
+    return h->Restore();
+}
+
+static bool DispatchReset ( MIDISCHandle *h, const MIDIShowControlCommand & )
+{
+    return h->Reset();
+}
+
+static bool DispatchSetClock ( MIDISCHandle *h, const MIDIShowControlCommand &c )
+{
+    if ( c.HasQList() )
+        return h->SetClock ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames, c.q_list.ToCue() );
+
+    return h->SetClock ( c.hours, c.minutes, c.seconds, c.frames, c.fract_frames );
+}
+
+
+MIDIShowControlDispatcher::MIDIShowControlDispatcher ( MIDISCHandle *handle_, uchar device_id_ )
+    : handle ( handle_ ),
+      device_id ( device_id_ )
+{
+    for ( int i = 0; i < 128; ++i )
+        table[i] = 0;
+
+    typedef MIDISCHandle H;
+
+    table[MIDI_SC_GO] = DispatchCues<&H::Go, &H::Go, &H::Go, &H::Go>;
+    table[MIDI_SC_STOP] = DispatchCues<&H::Stop, &H::Stop, &H::Stop, &H::Stop>;
+    table[MIDI_SC_RESUME] = DispatchCues<&H::Resume, &H::Resume, &H::Resume, &H::Resume>;
+    table[MIDI_SC_TIMED_GO] = DispatchTimedGo;
+    table[MIDI_SC_LOAD] = DispatchLoad;
+    table[MIDI_SC_SET] = DispatchSet;
+    table[MIDI_SC_FIRE] = DispatchFire;
+    table[MIDI_SC_ALL_OFF] = DispatchAllOff;
+    table[MIDI_SC_RESTORE] = DispatchRestore;
+    table[MIDI_SC_RESET] = DispatchReset;
+    table[MIDI_SC_GO_OFF] = DispatchCues<&H::GoOff, &H::GoOff, &H::GoOff, &H::GoOff>;
+    table[MIDI_SC_GO_JAM] = DispatchCues<&H::GoJam, &H::GoJam, &H::GoJam, &H::GoJam>;
+    table[MIDI_SC_STANDBY_PLUS] = DispatchList<&H::StandbyPlus, &H::StandbyPlus>;
+    table[MIDI_SC_STANDBY_MINUS] = DispatchList<&H::StandbyMinus, &H::StandbyMinus>;
+    table[MIDI_SC_SEQUENCE_PLUS] = DispatchList<&H::SequencePlus, &H::SequencePlus>;
+    table[MIDI_SC_SEQUENCE_MINUS] = DispatchList<&H::SequenceMinus, &H::SequenceMinus>;
+    table[MIDI_SC_START_CLOCK] = DispatchList<&H::StartClock, &H::StartClock>;
+    table[MIDI_SC_STOP_CLOCK] = DispatchList<&H::StopClock, &H::StopClock>;
+    table[MIDI_SC_ZERO_CLOCK] = DispatchList<&H::ZeroClock, &H::ZeroClock>;
+    table[MIDI_SC_SET_CLOCK] = DispatchSetClock;
+    table[MIDI_SC_MTC_CHASE_ON] = DispatchList<&H::MTCChaseOn, &H::MTCChaseOn>;
+    table[MIDI_SC_MTC_CHASE_OFF] = DispatchList<&H::MTCChaseOff, &H::MTCChaseOff>;
+    table[MIDI_SC_OPEN_Q_LIST] = DispatchListOnly<&H::OpenQList>;
+    table[MIDI_SC_CLOSE_Q_LIST] = DispatchListOnly<&H::CloseQList>;
+    table[MIDI_SC_OPEN_Q_PATH] = DispatchPathOnly<&H::OpenQPath>;
+    table[MIDI_SC_CLOSE_Q_PATH] = DispatchPathOnly<&H::CloseQPath>;
+}
+
+MIDIShowControlDispatcher::~MIDIShowControlDispatcher()
+{
+}
+
+bool MIDIShowControlDispatcher::Dispatch ( const MIDIShowControlCommand &cmd ) const
+{
+    if ( !handle )
+        return false;
+
+    if ( device_id != 0x7f && cmd.device_id != 0x7f && cmd.device_id != device_id )
+        return false;
+
+    CommandFunction f = table[cmd.command & 0x7f];
+    return f ? f ( handle, cmd ) : false;
+}
+
+bool MIDIShowControlDispatcher::Dispatch ( const uchar *data, int len ) const
+{
+    MIDIShowControlCommand cmd;
+    return MIDIShowControlParser::Parse ( data, len, &cmd ) && Dispatch ( cmd );
+}
+
+bool MIDIShowControlDispatcher::Dispatch ( const MIDIBigMessage &msg ) const
+{
+    const MIDISystemExclusive *sysex = msg.GetSysEx();
+
+    if ( !sysex || !( msg.IsSysExN() || msg.IsSysExA() ) )
+        return false;
+
+    return Dispatch ( sysex->GetBuf(), sysex->GetLengthSE() );
+}
+
+}
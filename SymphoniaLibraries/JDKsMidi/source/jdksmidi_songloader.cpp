@@ -0,0 +1,361 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/songloader.h"
+#include "jdksmidi/filereadlazy.h"
+
+#include <stdio.h>
+
+namespace jdksmidi
+{
+
+// a MIDIFileReadMultiTrack for single chunks of a file whose header was read elsewhere.
+// mf_header() would resize the multitrack, so the header values are set directly
+class MIDISongLoaderChunkReader : public MIDIFileReadMultiTrack
+{
+public:
+    MIDISongLoaderChunkReader ( MIDIMultiTrack *multitrack_, int format_, int num_tracks_, int division_ )
+        : MIDIFileReadMultiTrack ( multitrack_ )
+    {
+        the_format = format_;
+        num_tracks = num_tracks_;
+        division = division_;
+    }
+};
+
+
+MIDISongLoader::MIDISongLoader ( int num_threads_ )
+    : num_threads ( num_threads_ ),
+      music_end_clock ( 0 ),
+      stage ( STAGE_IDLE ),
+      cancel_request ( false )
+{
+    if ( num_threads <= 0 )
+        num_threads = ( int ) std::thread::hardware_concurrency();
+
+    if ( num_threads <= 0 )
+        num_threads = 1;
+
+    for ( int s = 0; s < NUM_PROGRESS_STAGES; ++s )
+        progress[s] = 0.0f;
+}
+
+MIDISongLoader::~MIDISongLoader()
+{
+    Cancel();
+}
+
+void MIDISongLoader::Start ( const char *fname )
+{
+    Cancel();
+
+    file_name = fname;
+    cancel_request = false;
+
+    for ( int s = 0; s < NUM_PROGRESS_STAGES; ++s )
+        progress[s] = 0.0f;
+
+    stage = STAGE_READ;
+    thread = std::thread ( &MIDISongLoader::ThreadProc, this );
+}
+
+void MIDISongLoader::Cancel()
+{
+    cancel_request = true;
+
+    if ( thread.joinable() )
+        thread.join();
+}
+
+bool MIDISongLoader::Wait()
+{
+    if ( thread.joinable() )
+        thread.join();
+
+    return IsReady();
+}
+
+float MIDISongLoader::GetProgress() const
+{
+    if ( stage == STAGE_READY )
+        return 1.0f;
+
+    // decoding and the warp index take the most time
+    static const float weight[NUM_PROGRESS_STAGES] = { 0.1f, 0.4f, 0.1f, 0.4f };
+    float f = 0.0f;
+
+    for ( int s = 0; s < NUM_PROGRESS_STAGES; ++s )
+        f += weight[s] * progress[s];
+
+    return f;
+}
+
+bool MIDISongLoader::Commit ( AdvancedSequencer *seq )
+{
+    if ( !IsReady() )
+        return false;
+
+    if ( thread.joinable() )
+        thread.join();
+
+    seq->Stop();
+    seq->mgr.SetSeq ( 0 );
+
+    if ( !seq->tracks.ClearAndResize ( tracks.GetNumTracks() ) )
+    {
+        seq->file_loaded = false;
+        seq->mgr.SetSeq ( &seq->seq );
+        return false;
+    }
+
+    seq->tracks.SetClksPerBeat ( tracks.GetClksPerBeat() );
+
+    for ( int trk = 0; trk < tracks.GetNumTracks(); ++trk )
+        *seq->tracks.GetTrack ( trk ) = std::move ( *tracks.GetTrack ( trk ) );
+
+    seq->file_loaded = true;
+    seq->Reset();
+
+    // the warp positions of ExtractWarpPositions(), from the snapshots
+    for ( int i = 0; i < seq->num_warp_positions; ++i )
+        delete seq->warp_positions[i];
+
+    seq->num_warp_positions = 0;
+
+    for ( size_t i = 0; i < warp_snapshots.size() && i < MAX_WARP_POSITIONS; ++i )
+    {
+        MIDISequencerState *state = new MIDISequencerState ( &seq->seq, &seq->tracks, &seq->notifier );
+        warp_snapshots[i].Restore ( state, warp_names );
+        seq->warp_positions[seq->num_warp_positions++] = state;
+    }
+
+    // the markers of ExtractMarkers()
+    seq->num_markers = 0;
+
+    for ( size_t i = 0; i < marker_times.size() && i < sizeof ( seq->marker_times ) / sizeof ( seq->marker_times[0] ); ++i )
+        seq->marker_times[seq->num_markers++] = marker_times[i];
+
+    seq->GoToMeasure ( 0 );
+    seq->mgr.SetSeq ( &seq->seq );
+
+    tracks.ClearAndResize ( 0 );
+    warp_snapshots.clear();
+    warp_names.Clear();
+    stage = STAGE_IDLE;
+    return true;
+}
+
+void MIDISongLoader::ThreadProc()
+{
+    file_data.clear();
+    marker_names.clear();
+    marker_times.clear();
+    warp_snapshots.clear();
+    warp_names.Clear();
+    tempo_map.Clear();
+    music_end_clock = 0;
+
+    bool ok = ReadFile();
+
+    if ( ok && !IsCancelled() )
+    {
+        stage = STAGE_DECODE;
+        ok = DecodeTracks();
+    }
+
+    // the chunks are decoded, the file data is not needed any more
+    file_data.clear();
+    file_data.shrink_to_fit();
+
+    if ( ok && !IsCancelled() )
+    {
+        // the tempo map and the warp index only read the tracks
+        stage = STAGE_INDEX;
+        std::thread tempo_thread ( &MIDISongLoader::BuildTempoMap, this );
+        ok = BuildWarpIndex();
+
+        tempo_thread.join();
+    }
+
+    if ( IsCancelled() )
+        stage = STAGE_CANCELLED;
+    else
+        stage = ok ? STAGE_READY : STAGE_FAILED;
+}
+
+bool MIDISongLoader::ReadFile()
+{
+    FILE *f = fopen ( file_name.c_str(), "rb" );
+
+    if ( !f )
+        return false;
+
+    bool ok = false;
+
+    if ( fseek ( f, 0, SEEK_END ) == 0 )
+    {
+        long size = ftell ( f );
+
+        if ( size > 0 && fseek ( f, 0, SEEK_SET ) == 0 )
+        {
+            const long piece = 65536;
+            long done = 0;
+
+            file_data.resize ( size );
+
+            while ( done < size && !IsCancelled() )
+            {
+                long len = size - done < piece ? size - done : piece;
+
+                if ( fread ( &file_data[done], 1, len, f ) != ( size_t ) len )
+                    break;
+
+                done += len;
+                SetProgress ( STAGE_READ, ( float ) done / size );
+            }
+
+            ok = ( done == size );
+        }
+    }
+
+    fclose ( f );
+    return ok;
+}
+
+bool MIDISongLoader::DecodeTracks()
+{
+    MIDIFileReadStreamMemory stream ( file_data.data(), ( unsigned long ) file_data.size() );
+    MIDIFileReadLazy lazy ( &stream, &tracks );
+
+    if ( !lazy.Index() )
+        return false;
+
+    // Commit() leaves no tracks, and a song which was not committed must not stay under the
+    // new one. a format 0 chunk is split over 17 tracks, track 0 and one for every channel
+    if ( !tracks.ClearAndResize ( lazy.GetFormat() == 0 ? 17 : lazy.GetNumTracks() ) )
+        return false;
+
+    music_end_clock = lazy.GetMusicEndClock();
+
+    int num_chunks = lazy.GetNumChunks();
+
+    // a format 0 song is one chunk
+    if ( lazy.GetFormat() == 0 || num_chunks <= 1 )
+    {
+        bool ok = lazy.DecodeAllTracks();
+        SetProgress ( STAGE_DECODE, 1.0f );
+        return ok;
+    }
+
+    // every thread takes the next chunk which is not decoded yet. the chunks are different
+    // tracks of the multitrack, so the threads do not share anything else
+    unsigned long total_len = 0;
+
+    for ( int chunk = 0; chunk < num_chunks; ++chunk )
+        total_len += lazy.GetChunkInfo ( chunk ).len;
+
+    std::atomic<int> next_chunk ( 0 );
+    std::atomic<unsigned long> done_len ( 0 );
+    std::atomic<bool> ok ( true );
+
+    auto decode = [&]()
+    {
+        MIDIFileReadStreamMemory chunk_stream ( file_data.data(), ( unsigned long ) file_data.size() );
+        MIDISongLoaderChunkReader loader ( &tracks, lazy.GetFormat(), lazy.GetNumTracks(), lazy.GetDivision() );
+        MIDIFileReadBlock reader ( &chunk_stream, &loader );
+
+        for ( int chunk = next_chunk++; chunk < num_chunks && !IsCancelled(); chunk = next_chunk++ )
+        {
+            const MIDIFileReadLazy::ChunkInfo &info = lazy.GetChunkInfo ( chunk );
+
+            if ( !reader.ReadTrackBlock ( chunk, info.data, info.len ) )
+                ok = false;
+
+            tracks.GetTrack ( chunk )->SortEventsOrder();
+
+            done_len += info.len;
+            SetProgress ( STAGE_DECODE, total_len ? ( float ) done_len / total_len : 1.0f );
+        }
+    };
+
+    int n = num_threads < num_chunks ? num_threads : num_chunks;
+    std::vector<std::thread> workers;
+
+    for ( int i = 1; i < n; ++i )
+        workers.push_back ( std::thread ( decode ) );
+
+    decode();
+
+    for ( size_t i = 0; i < workers.size(); ++i )
+        workers[i].join();
+
+    return ok;
+}
+
+void MIDISongLoader::BuildTempoMap()
+{
+    tempo_map.Build ( &tracks );
+
+    if ( IsCancelled() )
+        return;
+
+    // markers are in the first track, as for AdvancedSequencer::ExtractMarkers()
+    const MIDITrack *track = tracks.GetTrack ( 0 );
+
+    for ( int i = 0; track && i < track->GetNumEvents() && !IsCancelled(); ++i )
+    {
+        const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+        if ( msg->IsTextEvent() && msg->GetMetaType() == META_MARKER_TEXT )
+        {
+            const MIDISystemExclusive *sysex = msg->GetSysEx();
+            marker_names.push_back ( sysex ? std::string ( ( const char * ) sysex->GetBuf(), sysex->GetLengthSE() ) : std::string() );
+            marker_times.push_back ( msg->GetTime() );
+        }
+    }
+
+    if ( !IsCancelled() )
+        SetProgress ( STAGE_TEMPO_MAP, 1.0f );
+}
+
+bool MIDISongLoader::BuildWarpIndex()
+{
+    MIDISequencer seq ( &tracks );
+
+    for ( int i = 0; i < MAX_WARP_POSITIONS && !IsCancelled(); ++i )
+    {
+        if ( !seq.GoToMeasure ( i * MEASURES_PER_WARP, 0 ) )
+            break;
+
+        warp_snapshots.push_back ( MIDISequencerSnapshot() );
+        warp_snapshots.back().Capture ( seq, &warp_names );
+
+        if ( music_end_clock > 0 )
+        {
+            float f = ( float ) seq.GetCurrentMIDIClockTime() / music_end_clock;
+            SetProgress ( STAGE_WARP_INDEX, f < 1.0f ? f : 1.0f );
+        }
+    }
+
+    SetProgress ( STAGE_WARP_INDEX, 1.0f );
+    return true;
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/sysexpool.h"
+
+namespace jdksmidi
+{
+
+MIDISysExPool::MIDISysExPool()
+{
+}
+
+MIDISysExPool::~MIDISysExPool()
+{
+}
+
+void MIDISysExPool::Clear()
+{
+    blobs.clear();
+    data.clear();
+    blob_by_hash.clear();
+    next_blob.clear();
+}
+
+unsigned long MIDISysExPool::Hash ( const unsigned char *data, int len )
+{
+    // FNV-1a
+    unsigned long h = 2166136261UL;
+
+    for ( int i = 0; i < len; ++i )
+    {
+        h ^= data[i];
+        h = ( h * 16777619UL ) & 0xffffffffUL;
+    }
+
+    return h ^ ( unsigned long ) len;
+}
+
+long MIDISysExPool::Intern ( const unsigned char *blob_data, int len )
+{
+    if ( len < 0 )
+        len = 0;
+
+    unsigned long h = Hash ( blob_data, len );
+    std::unordered_map<unsigned long, long>::iterator it = blob_by_hash.find ( h );
+
+    if ( it != blob_by_hash.end() )
+    {
+        for ( long b = it->second; b != NO_BLOB; b = next_blob[b] )
+        {
+            if ( blobs[b].length == len && ( len == 0 || memcmp ( &data[blobs[b].offset], blob_data, len ) == 0 ) )
+                return b;
+        }
+    }
+
+    Blob blob;
+    blob.offset = ( unsigned long ) data.size();
+    blob.length = len;
+    data.insert ( data.end(), blob_data, blob_data + len );
+
+    long b = ( long ) blobs.size();
+    blobs.push_back ( blob );
+
+    if ( it != blob_by_hash.end() )
+    {
+        next_blob.push_back ( it->second );
+        it->second = b;
+    }
+    else
+    {
+        next_blob.push_back ( NO_BLOB );
+        blob_by_hash[h] = b;
+    }
+
+    return b;
+}
+
+}
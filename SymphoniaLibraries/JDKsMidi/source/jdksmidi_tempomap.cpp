@@ -0,0 +1,161 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/tempomap.h"
+#include "jdksmidi/sequencer.h"
+
+namespace jdksmidi
+{
+
+MIDITempoMap::MIDITempoMap()
+{
+    Clear();
+}
+
+MIDITempoMap::~MIDITempoMap()
+{
+}
+
+void MIDITempoMap::Clear()
+{
+    clks_per_beat = 120;
+    music_end_clock = 0;
+    segments.clear();
+
+    // if no tempo is defined, 120 beats per minute is assumed
+    AddSegment ( 0, 500000 );
+}
+
+void MIDITempoMap::Build ( const MIDIMultiTrack *multitrack, int conductor_track )
+{
+    segments.clear();
+    clks_per_beat = multitrack->GetClksPerBeat();
+    music_end_clock = 0;
+
+    AddSegment ( 0, 500000 );
+
+    if ( conductor_track < multitrack->GetNumTracks() )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( conductor_track );
+
+        for ( int i = 0; i < track->GetNumEvents(); ++i )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( msg->IsTempo() && msg->GetTempo() > 0 )
+                AddSegment ( msg->GetTime(), msg->GetTempo() );
+        }
+    }
+
+    // end of music is the time of last not end of track midi event
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = track->GetNumEvents() - 1; i >= 0; --i )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( msg->IsDataEnd() || msg->IsNoOp() )
+                continue;
+
+            if ( msg->GetTime() > music_end_clock )
+                music_end_clock = msg->GetTime();
+
+            break;
+        }
+    }
+}
+
+void MIDITempoMap::AddSegment ( MIDIClockTime clock, unsigned long us_per_quarter )
+{
+    Segment seg;
+    seg.clock = clock;
+    seg.us_per_quarter = us_per_quarter;
+    seg.ms_per_clock = us_per_quarter / ( 1000.0 * clks_per_beat );
+    seg.ms = 0.0;
+
+    if ( !segments.empty() )
+    {
+        const Segment &last = segments.back();
+
+        // a later tempo event at the same time replaces the earlier one
+        if ( last.clock == clock )
+        {
+            seg.ms = last.ms;
+            segments.back() = seg;
+            return;
+        }
+
+        seg.ms = SegmentClockToMs ( last, clock );
+    }
+
+    segments.push_back ( seg );
+}
+
+int MIDITempoMap::FindSegmentOfClock ( MIDIClockTime clock ) const
+{
+    int lo = 0;
+    int hi = ( int ) segments.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( segments[mid].clock <= clock )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+int MIDITempoMap::FindSegmentOfMs ( double ms ) const
+{
+    int lo = 0;
+    int hi = ( int ) segments.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( segments[mid].ms <= ms )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+
+bool MIDISequencer::GoToTimeMs ( double time_ms, const MIDITempoMap &tempo_map )
+{
+    // the map is for tempo scale 100%
+    return GoToTime ( tempo_map.MsToClock ( time_ms * tempo_scale * 0.01 ) );
+}
+
+double MIDISequencer::GetMusicDurationInMilliseconds ( const MIDITempoMap &tempo_map ) const
+{
+    return tempo_map.GetMusicDurationInMilliseconds() * 100.0 / tempo_scale;
+}
+
+}
@@ -0,0 +1,136 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/textindex.h"
+
+#include <algorithm>
+
+namespace jdksmidi
+{
+
+MIDITextIndex::MIDITextIndex()
+{
+}
+
+MIDITextIndex::~MIDITextIndex()
+{
+}
+
+void MIDITextIndex::Clear()
+{
+    entries.clear();
+
+    for ( int type = 0; type < 16; ++type )
+        entries_of_type[type].clear();
+
+    text_pool.Clear();
+}
+
+void MIDITextIndex::Build ( const MIDIMultiTrack *multitrack, const MIDITempoMap &tempo_map, unsigned int type_mask )
+{
+    Clear();
+
+    for ( int trk = 0; trk < multitrack->GetNumTracks(); ++trk )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( trk );
+
+        for ( int i = 0; i < track->GetNumEvents(); ++i )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( i );
+
+            if ( !msg->IsTextEvent() || ( type_mask & ( 1u << ( msg->GetMetaType() & 0x0f ) ) ) == 0 )
+                continue;
+
+            const MIDISystemExclusive *sysex = msg->GetSysEx();
+
+            Entry e;
+            e.clock = msg->GetTime();
+            e.ms = 0.0;
+            e.track = trk;
+            e.type = msg->GetMetaType() & 0x0f;
+            e.text = sysex ? text_pool.Intern ( *sysex ) : text_pool.Intern ( 0, 0 );
+            entries.push_back ( e );
+        }
+    }
+
+    // the tracks are each in time order, a stable sort keeps the events of a time by track
+    std::stable_sort ( entries.begin(), entries.end(), [] ( const Entry & a, const Entry & b )
+    {
+        return a.clock < b.clock;
+    } );
+
+    MIDITempoMapCursor cursor ( &tempo_map );
+
+    for ( int n = 0; n < ( int ) entries.size(); ++n )
+    {
+        entries[n].ms = cursor.ClockToMs ( entries[n].clock );
+        entries_of_type[entries[n].type].push_back ( n );
+    }
+}
+
+void MIDITextIndex::FindRange ( MIDIClockTime t0, MIDIClockTime t1, int *first, int *end ) const
+{
+    auto clock_less = [] ( const Entry & e, MIDIClockTime t )
+    {
+        return e.clock < t;
+    };
+
+    *first = ( int ) ( std::lower_bound ( entries.begin(), entries.end(), t0, clock_less ) - entries.begin() );
+    *end = t1 > t0 ? ( int ) ( std::lower_bound ( entries.begin() + *first, entries.end(), t1, clock_less ) - entries.begin() ) : *first;
+}
+
+void MIDITextIndex::FindRangeMs ( double ms0, double ms1, int *first, int *end ) const
+{
+    auto ms_less = [] ( const Entry & e, double ms )
+    {
+        return e.ms < ms;
+    };
+
+    *first = ( int ) ( std::lower_bound ( entries.begin(), entries.end(), ms0, ms_less ) - entries.begin() );
+    *end = ms1 > ms0 ? ( int ) ( std::lower_bound ( entries.begin() + *first, entries.end(), ms1, ms_less ) - entries.begin() ) : *first;
+}
+
+void MIDITextIndex::FindRangeOfType ( int type, MIDIClockTime t0, MIDIClockTime t1, int *first, int *end ) const
+{
+    const std::vector<int> &list = entries_of_type[type & 0x0f];
+
+    auto clock_less = [this] ( int n, MIDIClockTime t )
+    {
+        return entries[n].clock < t;
+    };
+
+    *first = ( int ) ( std::lower_bound ( list.begin(), list.end(), t0, clock_less ) - list.begin() );
+    *end = t1 > t0 ? ( int ) ( std::lower_bound ( list.begin() + *first, list.end(), t1, clock_less ) - list.begin() ) : *first;
+}
+
+void MIDITextIndex::FindRangeOfTypeMs ( int type, double ms0, double ms1, int *first, int *end ) const
+{
+    const std::vector<int> &list = entries_of_type[type & 0x0f];
+
+    auto ms_less = [this] ( int n, double ms )
+    {
+        return entries[n].ms < ms;
+    };
+
+    *first = ( int ) ( std::lower_bound ( list.begin(), list.end(), ms0, ms_less ) - list.begin() );
+    *end = ms1 > ms0 ? ( int ) ( std::lower_bound ( list.begin() + *first, list.end(), ms1, ms_less ) - list.begin() ) : *first;
+}
+
+}
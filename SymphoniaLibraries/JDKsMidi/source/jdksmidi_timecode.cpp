@@ -0,0 +1,238 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/timecode.h"
+
+namespace jdksmidi
+{
+
+MIDITimecode::MIDITimecode ( int64_t sample_rate_, int fps_num_, int fps_den_, bool drop_frame_, int sub_frames_per_frame_ )
+    : sample_rate ( sample_rate_ ),
+      sub_frames_per_frame ( sub_frames_per_frame_ ),
+      division ( 120 )
+{
+    SetFrameRate ( fps_num_, fps_den_, drop_frame_ );
+
+    // 120 bpm until a tempo map is given
+    Segment seg;
+    seg.clock = 0;
+    seg.us_per_quarter = 500000;
+    seg.units = 0;
+    segments.push_back ( seg );
+}
+
+MIDITimecode::~MIDITimecode()
+{
+}
+
+bool MIDITimecode::SetFrameRate ( int fps_num_, int fps_den_, bool drop_frame_ )
+{
+    fps_num = fps_num_;
+    fps_den = fps_den_;
+    nominal_fps = ( fps_num + fps_den - 1 ) / fps_den;
+
+    // drop frame is 2 frames a minute at 29.97 and 4 at 59.94
+    drop_frame = drop_frame_ && fps_den == 1001 && nominal_fps % 30 == 0;
+    drop_frames = drop_frame ? nominal_fps / 15 : 0;
+
+    return drop_frame == drop_frame_;
+}
+
+bool MIDITimecode::SetFrameRate ( SMPTE_RATE r )
+{
+    switch ( r )
+    {
+    case SMPTE_RATE_24:
+        return SetFrameRate ( 24 );
+
+    case SMPTE_RATE_25:
+        return SetFrameRate ( 25 );
+
+    case SMPTE_RATE_2997:
+        return SetFrameRate ( 30000, 1001 );
+
+    case SMPTE_RATE_2997DF:
+        return SetFrameRate ( 30000, 1001, true );
+
+    case SMPTE_RATE_30:
+        return SetFrameRate ( 30 );
+
+    case SMPTE_RATE_30DF:
+        // 30 drop frame is 29.97 drop frame running at 30 fps
+        SetFrameRate ( 30000, 1001, true );
+        fps_num = 30;
+        fps_den = 1;
+        return true;
+    }
+
+    return false;
+}
+
+void MIDITimecode::FrameToFields ( int64_t frame, MIDITimecodeFields *tc ) const
+{
+    // add the dropped frame numbers, then count with the nominal rate
+    if ( drop_frame )
+    {
+        int64_t frames_per_minute = nominal_fps * 60 - drop_frames;
+        int64_t frames_per_10_minutes = nominal_fps * 600 - drop_frames * 9;
+        int64_t tens = frame / frames_per_10_minutes;
+        int64_t rest = frame % frames_per_10_minutes;
+
+        frame += drop_frames * 9 * tens;
+
+        if ( rest > drop_frames )
+            frame += drop_frames * ( ( rest - drop_frames ) / frames_per_minute );
+    }
+
+    tc->frames = ( int ) ( frame % nominal_fps );
+    frame /= nominal_fps;
+    tc->seconds = ( int ) ( frame % 60 );
+    frame /= 60;
+    tc->minutes = ( int ) ( frame % 60 );
+    tc->hours = ( int ) ( frame / 60 );
+    tc->sub_frames = 0;
+}
+
+int64_t MIDITimecode::FieldsToFrame ( const MIDITimecodeFields &tc ) const
+{
+    int64_t total_minutes = ( int64_t ) tc.hours * 60 + tc.minutes;
+    int64_t frame = ( total_minutes * 60 + tc.seconds ) * nominal_fps + tc.frames;
+
+    if ( drop_frame )
+        frame -= drop_frames * ( total_minutes - total_minutes / 10 );
+
+    return frame;
+}
+
+void MIDITimecode::SampleToFields ( int64_t sample, MIDITimecodeFields *tc ) const
+{
+    int64_t sub_frame = SampleToSubFrame ( sample );
+    FrameToFields ( sub_frame / sub_frames_per_frame, tc );
+    tc->sub_frames = ( int ) ( sub_frame % sub_frames_per_frame );
+}
+
+int64_t MIDITimecode::FieldsToSample ( const MIDITimecodeFields &tc ) const
+{
+    return SubFrameToSample ( FieldsToFrame ( tc ) * sub_frames_per_frame + tc.sub_frames );
+}
+
+void MIDITimecode::SetTempoMap ( const MIDITempoMap &tempo_map )
+{
+    division = tempo_map.GetClksPerBeat();
+    segments.clear();
+
+    for ( int i = 0; i < tempo_map.GetNumSegments(); ++i )
+    {
+        const MIDITempoMap::Segment &map_seg = tempo_map.GetSegment ( i );
+        Segment seg;
+        seg.clock = map_seg.clock;
+        seg.us_per_quarter = map_seg.us_per_quarter;
+        seg.units = segments.empty() ? 0 : SegmentClockToUnits ( segments.back(), seg.clock );
+        segments.push_back ( seg );
+    }
+}
+
+int MIDITimecode::FindSegmentOfClock ( MIDIClockTime clock ) const
+{
+    int lo = 0;
+    int hi = ( int ) segments.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( segments[mid].clock <= clock )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+int MIDITimecode::FindSegmentOfUnits ( int64_t units ) const
+{
+    int lo = 0;
+    int hi = ( int ) segments.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( segments[mid].units <= units )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+void MIDITimecode::ClocksToSamples ( const MIDIClockTime *clocks, int64_t *samples, int num ) const
+{
+    int seg = 0;
+    int num_segments = ( int ) segments.size();
+
+    for ( int i = 0; i < num; ++i )
+    {
+        MIDIClockTime clock = clocks[i];
+
+        if ( clock < segments[seg].clock )
+            seg = FindSegmentOfClock ( clock );
+
+        while ( seg + 1 < num_segments && segments[seg + 1].clock <= clock )
+            ++seg;
+
+        samples[i] = ClockUnitsToSample ( SegmentClockToUnits ( segments[seg], clock ) );
+    }
+}
+
+void MIDITimecode::SamplesToClocks ( const int64_t *samples, MIDIClockTime *clocks, int num ) const
+{
+    int seg = 0;
+    int num_segments = ( int ) segments.size();
+
+    for ( int i = 0; i < num; ++i )
+    {
+        int64_t units = SampleToClockUnits ( samples[i] );
+
+        if ( units < segments[seg].units )
+            seg = FindSegmentOfUnits ( units );
+
+        while ( seg + 1 < num_segments && segments[seg + 1].units <= units )
+            ++seg;
+
+        clocks[i] = SegmentUnitsToClock ( segments[seg], units );
+    }
+}
+
+void MIDITimecode::SamplesToFields ( const int64_t *samples, MIDITimecodeFields *tcs, int num ) const
+{
+    for ( int i = 0; i < num; ++i )
+        SampleToFields ( samples[i], &tcs[i] );
+}
+
+void MIDITimecode::FieldsToSamples ( const MIDITimecodeFields *tcs, int64_t *samples, int num ) const
+{
+    for ( int i = 0; i < num; ++i )
+        samples[i] = FieldsToSample ( tcs[i] );
+}
+
+}
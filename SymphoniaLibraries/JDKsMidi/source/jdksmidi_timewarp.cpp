@@ -0,0 +1,129 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/timewarp.h"
+
+namespace jdksmidi
+{
+
+MIDITimeWarp::MIDITimeWarp()
+{
+    Reset();
+}
+
+MIDITimeWarp::~MIDITimeWarp()
+{
+}
+
+void MIDITimeWarp::Reset ( double wall_ms, double song_ms, double scale )
+{
+    Anchor a;
+    a.wall_ms = wall_ms;
+    a.song_ms = song_ms;
+    a.scale = ( scale > 0.0 ) ? scale : 0.0;
+
+    anchors.clear();
+    anchors.push_back ( a );
+    first_after_seek = 0;
+}
+
+void MIDITimeWarp::SetScale ( double wall_ms, double scale )
+{
+    Anchor a;
+    a.wall_ms = wall_ms;
+    a.song_ms = WallToSong ( wall_ms );
+    a.scale = ( scale > 0.0 ) ? scale : 0.0;
+
+    // several changes in one frame only need the last one
+    if ( anchors.back().wall_ms == wall_ms )
+        anchors.back() = a;
+    else
+        anchors.push_back ( a );
+}
+
+void MIDITimeWarp::Seek ( double wall_ms, double song_ms )
+{
+    Anchor a;
+    a.wall_ms = wall_ms;
+    a.song_ms = song_ms;
+    a.scale = anchors.back().scale;
+
+    if ( anchors.back().wall_ms == wall_ms )
+        anchors.back() = a;
+    else
+        anchors.push_back ( a );
+
+    first_after_seek = ( int ) anchors.size() - 1;
+}
+
+double MIDITimeWarp::SongToWall ( double song_ms ) const
+{
+    // song time never goes back after the last seek, so the anchors are sorted by song time too
+    int lo = first_after_seek;
+    int hi = ( int ) anchors.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( anchors[mid].song_ms <= song_ms )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    const Anchor &a = anchors[lo];
+
+    if ( a.scale <= 0.0 )
+        return a.wall_ms;
+
+    return a.wall_ms + ( song_ms - a.song_ms ) / a.scale;
+}
+
+void MIDITimeWarp::DiscardBefore ( double wall_ms )
+{
+    int first = FindAnchorOfWall ( wall_ms );
+
+    if ( first == 0 )
+        return;
+
+    anchors.erase ( anchors.begin(), anchors.begin() + first );
+    first_after_seek = ( first_after_seek > first ) ? first_after_seek - first : 0;
+}
+
+int MIDITimeWarp::FindAnchorOfWall ( double wall_ms ) const
+{
+    int lo = 0;
+    int hi = ( int ) anchors.size() - 1;
+
+    while ( lo < hi )
+    {
+        int mid = ( lo + hi + 1 ) / 2;
+
+        if ( anchors[mid].wall_ms <= wall_ms )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+}
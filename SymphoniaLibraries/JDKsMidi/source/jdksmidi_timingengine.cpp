@@ -0,0 +1,169 @@
+/*
+  libjdksmidi C++ Class Library for MIDI addendum
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program;
+  if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/timingengine.h"
+
+#include <chrono>
+
+namespace jdksmidi
+{
+
+MIDITimingSteadyClock::MIDITimingSteadyClock ( int64_t spin_ns_ )
+    : spin_ns ( spin_ns_ ),
+      total_sleep_ns ( 0 ),
+      total_spin_ns ( 0 )
+{
+}
+
+MIDITimingSteadyClock::~MIDITimingSteadyClock()
+{
+}
+
+int64_t MIDITimingSteadyClock::GetTimeNs() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void MIDITimingSteadyClock::WaitUntilNs ( int64_t deadline_ns )
+{
+    int64_t now = GetTimeNs();
+
+    if ( deadline_ns - now > spin_ns )
+    {
+        int64_t wake_ns = deadline_ns - spin_ns;
+        std::this_thread::sleep_until ( std::chrono::steady_clock::time_point (
+                                            std::chrono::duration_cast<std::chrono::steady_clock::duration> (
+                                                    std::chrono::nanoseconds ( wake_ns ) ) ) );
+
+        int64_t woke = GetTimeNs();
+        total_sleep_ns += woke - now;
+        now = woke;
+    }
+
+    if ( now < deadline_ns )
+    {
+        int64_t spin_start = now;
+
+        while ( now < deadline_ns )
+        {
+            std::this_thread::yield();
+            now = GetTimeNs();
+        }
+
+        total_spin_ns += now - spin_start;
+    }
+}
+
+
+MIDITimingEngine::MIDITimingEngine ( MIDITick *tick_, MIDITimingClock *clock_, int64_t period_ns_ )
+    : tick ( tick_ ),
+      clock ( clock_ ),
+      period_ns ( period_ns_ ),
+      time_offset_ms ( 0 ),
+      start_ns ( 0 ),
+      next_deadline_ns ( 0 ),
+      num_ticks ( 0 ),
+      num_late_ticks ( 0 ),
+      max_lateness_ns ( 0 ),
+      running ( false ),
+      stop_request ( false )
+{
+}
+
+MIDITimingEngine::~MIDITimingEngine()
+{
+    Stop();
+}
+
+bool MIDITimingEngine::Start()
+{
+    if ( running )
+        return false;
+
+    Begin();
+    stop_request = false;
+    running = true;
+    thread = std::thread ( &MIDITimingEngine::ThreadProc, this );
+    return true;
+}
+
+void MIDITimingEngine::Stop()
+{
+    stop_request = true;
+
+    if ( thread.joinable() )
+        thread.join();
+
+    running = false;
+}
+
+void MIDITimingEngine::Run ( int64_t duration_ns )
+{
+    Begin();
+
+    int64_t end_ns = start_ns + duration_ns;
+
+    while ( next_deadline_ns <= end_ns )
+        Step();
+}
+
+void MIDITimingEngine::Begin()
+{
+    start_ns = clock->GetTimeNs();
+    next_deadline_ns = start_ns;
+    num_ticks = 0;
+    num_late_ticks = 0;
+    max_lateness_ns = 0;
+}
+
+void MIDITimingEngine::Step()
+{
+    int64_t deadline = next_deadline_ns;
+
+    clock->WaitUntilNs ( deadline );
+
+    int64_t lateness = clock->GetTimeNs() - deadline;
+
+    if ( lateness > max_lateness_ns )
+        max_lateness_ns = lateness;
+
+    // the next deadline is on the grid of the start time, missed deadlines are skipped
+    next_deadline_ns = deadline + period_ns;
+
+    if ( lateness > period_ns )
+    {
+        ++num_late_ticks;
+        next_deadline_ns += ( lateness / period_ns ) * period_ns;
+    }
+
+    ++num_ticks;
+    tick->TimeTick ( time_offset_ms + ( unsigned long ) ( ( deadline - start_ns ) / 1000000 ) );
+}
+
+void MIDITimingEngine::ThreadProc()
+{
+    while ( !stop_request )
+        Step();
+
+    running = false;
+}
+
+}
@@ -32,6 +32,22 @@ extern "C"
         return success;
     }
 
+    __declspec(dllexport) bool ParseMidiData(const unsigned char* midiData, int midiDataLength)
+    {
+        if (g_midiDataHandler == nullptr)
+        {
+            g_midiDataHandler = new MidiDataHandler();
+        }
+
+        if (midiData == nullptr || midiDataLength <= 0)
+        {
+            return false;
+        }
+
+        // Midi file already in memory (eg. TextAsset bytes). Only read during the parse, so the caller can release it afterwards.
+        return g_midiDataHandler->Parse(midiData, (size_t)midiDataLength);
+    }
+
     __declspec(dllexport) double GetMidiDuration()
     {
         if (g_midiDataHandler == nullptr)